@@ -1,19 +1,61 @@
 #version 450 core
 
+// BlockVertex
 in vec3 in_position;
 in vec2 in_texposition;
 in int in_textid;
 
+// PackedBlockVertex, see src/engine/component/mesh.h
+in uint in_packed;
+uniform bool packed_vertex;
+
+// Origin of the chunk in the world, x and z, see MeshArena
+in ivec2 in_origin;
+
 out vec2 out_texposition;
 out int out_textid;
 
-uniform mat4 model;
-uniform mat4 world;
-uniform mat4 proj;
+// Written once per frame, see World::camera_block
+layout(std140, row_major, binding = 0) uniform Camera {
+    mat4 proj;
+    mat4 model;
+};
+
+// FaceKind
+const uint Top = 0u;
+const uint Bottom = 1u;
+const uint Front = 2u;
+const uint Back = 3u;
+const uint Left = 4u;
+const uint Right = 5u;
+
+// The texture goes along the axes of the face, same orientation as the
+// texture coordinates of BlockVertex
+vec2 face_texposition(uint face, vec3 p) {
+    switch (face) {
+        case Top: return vec2(p.x, -p.z);
+        case Bottom: return vec2(p.x, p.z);
+        case Front: return vec2(p.x, -p.y);
+        case Back: return vec2(-p.x, -p.y);
+        case Left: return vec2(-p.z, -p.y);
+        default: return vec2(p.z, -p.y);  // Right
+    }
+}
 
 void main(void) {
-    gl_Position = proj * world * model * vec4(in_position, 1.0);
+    vec3 position;
+    if (packed_vertex) {
+        position = vec3(float(in_packed & 0x1Fu),
+                        float((in_packed >> 10) & 0x1FFu),
+                        float((in_packed >> 5) & 0x1Fu));
+        out_texposition = face_texposition((in_packed >> 19) & 0x7u, position);
+        out_textid = int((in_packed >> 22) & 0xFFu);
+    } else {
+        position = in_position;
+        out_texposition = in_texposition;
+        out_textid = in_textid;
+    }
 
-    out_texposition = in_texposition;
-    out_textid = in_textid;
+    const vec4 origin = vec4(in_origin.x, 0.0, in_origin.y, 0.0);
+    gl_Position = proj * (model * vec4(position, 1.0) + origin);
 }
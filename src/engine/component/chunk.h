@@ -1,13 +1,19 @@
 #ifndef CHUNK_H_
 #define CHUNK_H_
 
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
-#include <stdexcept>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "../data_structure/chunk_array.h"
+#include "../data_structure/palette_array.h"
+#include "../data_structure/scratch_arena.h"
 #include "../utils/logging.h"
 #include "../utils/mat.h"
 #include "../utils/profiler.h"
@@ -20,57 +26,127 @@ using array3d = std::array<std::array<std::array<T, L>, M>, N>;
 const int chunkWidth = 8;
 const int chunkHeight = 256;
 
-struct chunk_identifier {
-    int x;
-    int z;
-};
-
 using block_chunk_coord = math::vec<std::size_t, 3>;
 
 enum class BlockType { Empty, Grass };
 
 struct BlockData {
     BlockType type = BlockType::Empty;
+
+    bool operator==(const BlockData&) const = default;
 };
 
+// A chunk is cut vertically into sections, each with its own storage. Sections
+// made of a single kind of block cost (almost) nothing and are skipped by the
+// meshing
+const int chunkSectionHeight = 16;
+const int chunkSectionCount = chunkHeight / chunkSectionHeight;
+static_assert(chunkSectionCount * chunkSectionHeight == chunkHeight);
+
+const std::size_t chunkSectionBlockCount =
+    chunkWidth * chunkSectionHeight * chunkWidth;
+using block_storage = palette_array<BlockData, chunkSectionBlockCount>;
+
+// One bit per section, for the sections whose mesh has to be rebuilt
+using section_mask = std::uint32_t;
+static_assert(chunkSectionCount <= 32);
+constexpr section_mask sectionMaskOf(int y) {
+    return section_mask{1} << static_cast<unsigned>(y / chunkSectionHeight);
+}
+
+// A whole horizontal layer of a chunk as a bit mask
+using layer_mask = std::uint64_t;
+static_assert(chunkWidth * chunkWidth <= 64);
+const layer_mask full_layer =
+    chunkWidth * chunkWidth == 64
+        ? ~layer_mask{0}
+        : (layer_mask{1} << chunkWidth * chunkWidth) - 1;
+
 using chunk_range_it =
     range_it<std::size_t, chunkWidth, chunkHeight, chunkWidth>;
+using section_range_it =
+    range_it<std::size_t, chunkWidth, chunkSectionHeight, chunkWidth>;
 struct Chunk {
     // TODO: makes sure copy ctor and move ctor deals with deleting old context
    public:
-    Chunk(chunk_identifier id) : id{id} {}
+    // Only air, see TerrainGenerator for actual terrain
+    Chunk(chunk_identifier id) : id{id} { heights.fill(-1); }
+    Chunk(chunk_identifier id,
+          std::array<block_storage, chunkSectionCount> sections)
+        : id{id}, sections(std::move(sections)) {
+        for (int z = 0; z < chunkWidth; z++)
+            for (int x = 0; x < chunkWidth; x++)
+                height(x, z) = scanHeight(x, chunkHeight - 1, z);
+    }
 
     [[nodiscard]] chunk_identifier getId() const { return id; }
     [[nodiscard]] BlockData getBlock(block_chunk_coord coords) const {
         auto [x, y, z] = coords.data;
 
         assert(x < chunkWidth && y < chunkHeight && z < chunkWidth);
-        if (y > 2 + (unsigned int)std::abs(id.x) + (unsigned int)std::abs(id.z))
-            return {BlockType::Empty};
-        return {BlockType::Grass};
+        return sections[y / chunkSectionHeight].get(
+            block_index(x, y % chunkSectionHeight, z));
+    }
+
+    // Highest non air block of the column, -1 if there is none
+    [[nodiscard]] int getHeight(std::size_t x, std::size_t z) const {
+        assert(x < chunkWidth && z < chunkWidth);
+        return heights[x + chunkWidth * z];
+    }
+
+    // Highest non air block of the chunk, -1 if there is none
+    [[nodiscard]] int getMaxHeight() const {
+        return *std::max_element(heights.begin(), heights.end());
+    }
+
+    // One bit per block of the horizontal layer y, set if the block is not
+    // air. Bit x + chunkWidth * z is the block at x z
+    [[nodiscard]] layer_mask getLayerMask(std::size_t y) const {
+        assert(y < chunkHeight);
+        const auto& section = sections[y / chunkSectionHeight];
+        if (section.is_uniform())
+            return section.get(0).type == BlockType::Empty ? 0 : full_layer;
+
+        layer_mask mask = 0;
+        const std::size_t first = block_index(0, y % chunkSectionHeight, 0);
+        for (std::size_t i = 0; i < chunkWidth * chunkWidth; i++)
+            if (section.get(first + i).type != BlockType::Empty)
+                mask |= layer_mask{1} << i;
+        return mask;
+    }
+
+    [[nodiscard]] const block_storage& getSection(std::size_t section) const {
+        return sections[section];
+    }
+
+    // Section only made of air
+    [[nodiscard]] bool isSectionEmpty(std::size_t section) const {
+        return sections[section].is_uniform() &&
+               sections[section].get(0).type == BlockType::Empty;
+    }
+
+    // Section without any air
+    [[nodiscard]] bool isSectionFull(std::size_t section) const {
+        return sections[section].is_uniform() &&
+               sections[section].get(0).type != BlockType::Empty;
     }
 
     [[nodiscard]] BlockTexture getBlockTexture(block_chunk_coord coords,
                                                FaceKind kind) const {
         switch (getBlock(coords).type) {
             case BlockType::Grass:
+                // Only the surface of the terrain is covered with grass
+                if (static_cast<int>(coords[1]) !=
+                    getHeight(coords[0], coords[2]))
+                    return BlockTexture::GrassBottom;
                 switch (kind) {
                     case FaceKind::Front:
                     case FaceKind::Back:
                     case FaceKind::Left:
                     case FaceKind::Right:
-                        if (coords[1] < chunkHeight - 1 &&
-                            getBlock(coords + block_chunk_coord{0, 1, 0})
-                                    .type != BlockType::Empty)
-                            return BlockTexture::GrassBottom;
                         return BlockTexture::GrassSide;
-                    case FaceKind::Top: {
-                        if (coords[1] < chunkHeight - 1 &&
-                            getBlock(coords + block_chunk_coord{0, 1, 0})
-                                    .type != BlockType::Empty)
-                            return BlockTexture::GrassBottom;
+                    case FaceKind::Top:
                         return BlockTexture::GrassTop;
-                    }
                     case FaceKind::Bottom:
                     default:
                         return BlockTexture::GrassBottom;
@@ -82,73 +158,659 @@ struct Chunk {
         }
     }
 
-    void setBlock(int x, int y, int z, BlockData data) {
-        (void)this, (void)x, (void)y, (void)z, (void)data;
-        throw std::runtime_error{"not implemented yet"};
+    // Returns the sections whose mesh may have changed: the ones of the block
+    // and of the blocks above and below it, and the ones of the old and new
+    // top of the column, which have the grass texture
+    section_mask setBlock(int x, int y, int z, BlockData data) {
+        assert(0 <= x && x < chunkWidth && 0 <= y && y < chunkHeight &&
+               0 <= z && z < chunkWidth);
+        sections[y / chunkSectionHeight].set(
+            block_index(static_cast<std::size_t>(x),
+                        static_cast<std::size_t>(y % chunkSectionHeight),
+                        static_cast<std::size_t>(z)),
+            data);
+
+        auto& column = height(x, z);
+        const int old_height = column;
+        if (data.type != BlockType::Empty)
+            column = std::max(column, static_cast<std::int16_t>(y));
+        else if (y == column) column = scanHeight(x, y - 1, z);
+
+        section_mask dirty = sectionMaskOf(y);
+        if (y > 0) dirty |= sectionMaskOf(y - 1);
+        if (y + 1 < chunkHeight) dirty |= sectionMaskOf(y + 1);
+        if (old_height >= 0) dirty |= sectionMaskOf(old_height);
+        if (column >= 0) dirty |= sectionMaskOf(column);
+        return dirty;
+    }
+
+    // Fills a whole section with the same block
+    void fillSection(std::size_t section, BlockData data) {
+        sections[section].fill(data);
+
+        const int bottom = static_cast<int>(section) * chunkSectionHeight;
+        const int top = bottom + chunkSectionHeight - 1;
+        for (int z = 0; z < chunkWidth; z++) {
+            for (int x = 0; x < chunkWidth; x++) {
+                auto& column = height(x, z);
+                if (data.type != BlockType::Empty)
+                    column = std::max(column, static_cast<std::int16_t>(top));
+                else if (bottom <= column && column <= top)
+                    column = scanHeight(x, bottom - 1, z);
+            }
+        }
+    }
+
+    // Drops the kinds of blocks the edits removed from the sections: an edited
+    // section back to a single kind of block is uniform again, so it is
+    // skipped by the meshing and cheap to store
+    void compactSections(section_mask mask) {
+        for (std::size_t i = 0; i < chunkSectionCount; i++)
+            if (mask & (section_mask{1} << i)) sections[i].compact();
+    }
+
+    // Memory used by the blocks of this chunk
+    [[nodiscard]] std::size_t bytes() const {
+        std::size_t total = 0;
+        for (const auto& section : sections) total += section.bytes();
+        return total + sizeof(heights);
     }
 
    private:
+    // y is the slowest changing coordinate so that horizontal layers are
+    // contiguous
+    static std::size_t block_index(std::size_t x, std::size_t y,
+                                   std::size_t z) {
+        return x + chunkWidth * (z + chunkWidth * y);
+    }
+
+    std::int16_t& height(int x, int z) {
+        return heights[static_cast<std::size_t>(x + chunkWidth * z)];
+    }
+
+    // Highest non air block of the column at or below from
+    [[nodiscard]] std::int16_t scanHeight(int x, int from, int z) const {
+        for (int y = from; y >= 0; y--) {
+            const auto section =
+                static_cast<std::size_t>(y / chunkSectionHeight);
+            if (isSectionEmpty(section)) {
+                y -= y % chunkSectionHeight;  // to the bottom of the section
+                continue;
+            }
+
+            const auto block = sections[section].get(block_index(
+                static_cast<std::size_t>(x),
+                static_cast<std::size_t>(y % chunkSectionHeight),
+                static_cast<std::size_t>(z)));
+            if (block.type != BlockType::Empty)
+                return static_cast<std::int16_t>(y);
+        }
+        return -1;
+    }
+
     chunk_identifier id;
+    std::array<block_storage, chunkSectionCount> sections{};
+    // Highest non air block of each column, at x + chunkWidth * z
+    std::array<std::int16_t, chunkWidth * chunkWidth> heights{};
+};
+
+enum class MeshingMode {
+    PerFace,  // one quad per visible block face
+    Greedy,   // coplanar faces with the same texture merged into rectangles
 };
 
+// The four horizontal neighbours of a chunk, in the order of
+// neighbourOffsets. nullptr for the ones that are not loaded
+using chunk_neighbours = std::array<std::shared_ptr<const Chunk>, 4>;
+const std::array<chunk_identifier, 4> neighbourOffsets{{
+    {1, 0},   // Right
+    {-1, 0},  // Left
+    {0, 1},   // Back
+    {0, -1},  // Front
+}};
+// Index of the neighbour on the other side
+inline std::size_t oppositeNeighbour(std::size_t i) { return i ^ 1U; }
+
+// Sections of the neighbour i whose mesh may have changed with the block
+// x y z of a chunk: none unless the block is on the border with it
+inline section_mask borderSections(std::size_t i, int x, int y, int z) {
+    const int last = chunkWidth - 1;
+    const std::array<bool, 4> on_border{x == last, x == 0, z == last, z == 0};
+    return on_border[i] ? sectionMaskOf(y) : 0;
+}
+
+// One bit per FaceKind
+using face_mask = std::uint8_t;
+constexpr face_mask faceMaskOf(FaceKind kind) {
+    return static_cast<face_mask>(1U << static_cast<unsigned>(kind));
+}
+const face_mask allFaces = (1U << faceKindCount) - 1;
+// Face on the other side of the block, the FaceKinds go by pairs
+constexpr FaceKind oppositeFace(FaceKind kind) {
+    return static_cast<FaceKind>(static_cast<unsigned>(kind) ^ 1U);
+}
+
+// Which faces of a section can be seen through from which other faces: two
+// faces are connected when air blocks on both of them are connected through
+// the air of the section
+struct section_visibility {
+    std::array<face_mask, faceKindCount> reachable{};
+
+    static constexpr section_visibility all() {
+        section_visibility res;
+        res.reachable.fill(allFaces);
+        return res;
+    }
+
+    // Connects every pair of faces of the mask
+    constexpr void connect(face_mask faces) {
+        for (std::size_t i = 0; i < faceKindCount; i++)
+            if ((faces >> i & 1U) != 0) reachable[i] |= faces;
+    }
+
+    [[nodiscard]] constexpr bool connected(FaceKind from, FaceKind to) const {
+        return (reachable[static_cast<std::size_t>(from)] & faceMaskOf(to)) !=
+               0;
+    }
+
+    bool operator==(const section_visibility&) const = default;
+};
+using chunk_visibility = std::array<section_visibility, chunkSectionCount>;
+
+// The blocks of a chunk are shared and immutable once meshed, so that workers
+// can read the neighbours of a chunk while meshing it
 class ChunkSimplifyerProxy {
    public:
-    ChunkSimplifyerProxy(chunk_identifier id) : chunk(id) { simplify(); }
+    ChunkSimplifyerProxy(Chunk&& chunk,
+                         MeshingMode meshing_mode = MeshingMode::PerFace,
+                         const chunk_neighbours& neighbours = {})
+        : ChunkSimplifyerProxy(std::make_shared<const Chunk>(std::move(chunk)),
+                               meshing_mode, neighbours) {}
+    ChunkSimplifyerProxy(std::shared_ptr<const Chunk> chunk,
+                         MeshingMode meshing_mode = MeshingMode::PerFace,
+                         const chunk_neighbours& neighbours = {})
+        : chunk(std::move(chunk)), meshing_mode(meshing_mode) {
+        simplify(neighbours);
+    }
     ChunkSimplifyerProxy(ChunkSimplifyerProxy&&) noexcept = default;
     ChunkSimplifyerProxy& operator=(ChunkSimplifyerProxy&& other) = default;
 
-    void setBlock(int x, int y, int z, const BlockData& data) {
-        chunk.setBlock(x, y, z, data);
+    [[nodiscard]] BlockData getBlock(block_chunk_coord coords) const {
+        return chunk->getBlock(coords);
     }
 
-    [[nodiscard]] BlockData getBlock(block_chunk_coord coords) const {
-        return chunk.getBlock(coords);
+    [[nodiscard]] chunk_identifier getId() const { return chunk->getId(); }
+    [[nodiscard]] const Chunk& getChunk() const { return *chunk; }
+    [[nodiscard]] const std::shared_ptr<const Chunk>& getSharedChunk() const {
+        return chunk;
+    }
+
+    // Memory used by the blocks and the mesh
+    [[nodiscard]] std::size_t bytes() const {
+        return chunk->bytes() + mesh.bytes();
+    }
+
+    [[nodiscard]] MeshingMode getMeshingMode() const { return meshing_mode; }
+    void setMeshingMode(MeshingMode mode,
+                        const chunk_neighbours& neighbours = {}) {
+        meshing_mode = mode;
+        simplify(neighbours);
+    }
+
+    // Visibility of the sections through their air, updated with the mesh,
+    // see OcclusionCuller
+    [[nodiscard]] const chunk_visibility& getVisibility() const {
+        return visibility;
+    }
+
+    // Quads of the mesh from the section first to the section last, excluded
+    [[nodiscard]] std::pair<std::size_t, std::size_t> getSectionQuads(
+        std::size_t first, std::size_t last) const {
+        return {section_quads[first], section_quads[last]};
     }
 
-    [[nodiscard]] chunk_identifier getId() const { return chunk.getId(); }
+    // Whether the neighbour i was known when the mesh was built. If not, the
+    // faces on that border are all in the mesh
+    [[nodiscard]] bool hasNeighbour(std::size_t i) const {
+        return meshed_with[i];
+    }
 
-    void simplify() {
+    // Faces against the blocks of the neighbours are hidden. The mesh is
+    // built in the scratch buffers of the thread, then copied to its exact
+    // size
+    void simplify(const chunk_neighbours& neighbours = {}) {
         PROFILE_SCOPED();
+        for (std::size_t i = 0; i < neighbours.size(); i++)
+            meshed_with[i] = neighbours[i] != nullptr;
+
+        scratch_arena<mesh_scratch> scratch;
+        auto& built = scratch->mesh;
+        built.clear();
+        for (std::size_t section = 0; section < chunkSectionCount; section++) {
+            section_quads[section] = built.quadCount();
+            meshSection(section, neighbours, built);
+            visibility[section] = sectionVisibility(section);
+        }
+        section_quads.back() = built.quadCount();
+        mesh.assignVertices(built);
+    }
+
+    // Replaces the blocks with an edited copy of them and only rebuilds the
+    // dirty sections, with the neighbours the rest of the mesh was built
+    // with. Returns the first vertex of the mesh that changed
+    std::size_t remeshSections(std::shared_ptr<const Chunk> blocks,
+                               section_mask dirty,
+                               const chunk_neighbours& neighbours = {}) {
+        PROFILE_SCOPED();
+        chunk = std::move(blocks);
+        chunk_neighbours known;
+        for (std::size_t i = 0; i < neighbours.size(); i++)
+            if (meshed_with[i]) known[i] = neighbours[i];
+
+        std::size_t first_changed = mesh.size();
+        scratch_arena<mesh_scratch> scratch;
+        auto& section_mesh = scratch->mesh;
+        // From the top, so that the quads of the sections below do not move
+        for (std::size_t section = chunkSectionCount; section-- > 0;) {
+            if ((dirty >> section & 1U) == 0) continue;
+
+            section_mesh.clear();
+            meshSection(section, known, section_mesh);
+            visibility[section] = sectionVisibility(section);
+
+            const std::size_t first = section_quads[section];
+            const std::size_t count = section_quads[section + 1] - first;
+            mesh.replaceQuads(first, count, section_mesh);
+            for (std::size_t above = section + 1; above <= chunkSectionCount;
+                 above++)
+                section_quads[above] =
+                    section_quads[above] - count + section_mesh.quadCount();
+            first_changed = first * verticesPerQuad;
+        }
+        return first_changed;
+    }
+
+    // Reference implementation of simplify(), looks at the neighbours of each
+    // block one by one
+    void simplifyPerBlock(const chunk_neighbours& neighbours = {}) {
+        PROFILE_SCOPED();
+        mesh.clear();
+        for (std::size_t i = 0; i < neighbours.size(); i++)
+            meshed_with[i] = neighbours[i] != nullptr;
+
         auto conditionalAddBlockFace = [&](block_chunk_coord coords,
                                            block_chunk_coord neighbour,
                                            FaceKind kind) {
-            if (neighbour != coords &&  // chunk borders
-                chunk.getBlock(neighbour).type != BlockType::Empty)
-                return false;
+            const auto block = neighbour != coords
+                                   ? chunk->getBlock(neighbour)
+                                   : getOutsideBlock(neighbours, coords, kind);
+            if (block.type != BlockType::Empty) return;
 
             mesh.addBlockFace(coords, kind,
-                              chunk.getBlockTexture(coords, kind));
-            return true;
+                              chunk->getBlockTexture(coords, kind));
         };
 
-        for (auto [x, y, z] : chunk_range_it{}) {
-            block_chunk_coord coords{x, y, z};
-            bool visible = false;
-            if (chunk.getBlock(coords).type == BlockType::Empty) continue;
-            auto neighbours = get_neighbours(coords);
-            visible |=
+        for (std::size_t section = 0; section < chunkSectionCount; section++) {
+            section_quads[section] = mesh.quadCount();
+            visibility[section] = sectionVisibility(section);
+            const std::size_t bottom = section * chunkSectionHeight;
+            if (chunk->isSectionEmpty(section)) continue;
+
+            // Only the shell of a full section can have visible faces
+            const bool full = chunk->isSectionFull(section);
+
+            for (auto [x, local_y, z] : section_range_it{}) {
+                // Nothing above the surface
+                if (static_cast<int>(bottom + local_y) > chunk->getHeight(x, z))
+                    continue;
+                if (full && 0 < x && x + 1 < chunkWidth && 0 < z &&
+                    z + 1 < chunkWidth && 0 < local_y &&
+                    local_y + 1 < chunkSectionHeight)
+                    continue;
+
+                block_chunk_coord coords{x, bottom + local_y, z};
+                if (chunk->getBlock(coords).type == BlockType::Empty) continue;
+                auto neighbours = get_neighbours(coords);
                 conditionalAddBlockFace(coords, neighbours[0], FaceKind::Right);
-            visible |=
                 conditionalAddBlockFace(coords, neighbours[1], FaceKind::Top);
-            visible |=
                 conditionalAddBlockFace(coords, neighbours[2], FaceKind::Back);
-            visible |=
                 conditionalAddBlockFace(coords, neighbours[3], FaceKind::Left);
-            visible |= conditionalAddBlockFace(coords, neighbours[4],
-                                               FaceKind::Bottom);
-            visible |=
+                conditionalAddBlockFace(coords, neighbours[4],
+                                        FaceKind::Bottom);
                 conditionalAddBlockFace(coords, neighbours[5], FaceKind::Front);
-
-            if (visible) log << "Block " << coords << " is visible";
+            }
         }
+        section_quads.back() = mesh.quadCount();
     }
 
-    Chunk chunk;
-
-    using mesh_type = MeshChunk;
+    // The packed vertices are 6 times smaller
+    using mesh_type = PackedMeshChunk;
+    static_assert(chunkWidth <= PackedBlockVertex::max_horizontal &&
+                  chunkHeight <= PackedBlockVertex::max_height);
     mesh_type mesh;
 
    private:
+    // Working buffers of the mesher, see scratch_arena
+    struct mesh_scratch {
+        mesh_type mesh;
+    };
+    struct greedy_scratch {
+        std::array<std::vector<layer_mask>, faceKindCount> visible;
+        std::vector<int> plane;
+    };
+
+    // The faces of the blocks of a section, appended to out. Sections are
+    // meshed separately so that they can be rebuilt on their own
+    void meshSection(std::size_t section, const chunk_neighbours& neighbours,
+                     mesh_type& out) const {
+        if (chunk->isSectionEmpty(section)) return;
+
+        const std::size_t first = section * chunkSectionHeight;
+        const std::size_t last =
+            std::min(first + chunkSectionHeight,
+                     static_cast<std::size_t>(chunk->getMaxHeight() + 1));
+        switch (meshing_mode) {
+            case MeshingMode::Greedy:
+                simplifyGreedy(neighbours, first, last, out);
+                break;
+            case MeshingMode::PerFace:
+            default:
+                forEachVisibleFaces(
+                    neighbours, first, last,
+                    [&](layer_mask visible, std::size_t y, FaceKind kind) {
+                        addLayerFaces(visible, y, kind, out);
+                    });
+                break;
+        }
+    }
+
+    // Computes the visible faces a whole layer at a time: a face is visible if
+    // the block is solid and its neighbour is not, which is a shift and an
+    // and-not of the layer masks. Faces on the borders of the chunk are always
+    // visible. f(visible, y, kind) is called for every layer from first to
+    // last, excluded, and every face kind
+    template <typename F>
+    void forEachVisibleFaces(const chunk_neighbours& neighbours,
+                             std::size_t first, std::size_t last,
+                             F&& f) const {
+        if (first >= last) return;
+
+        layer_mask below = first > 0 ? chunk->getLayerMask(first - 1) : 0;
+        layer_mask current = chunk->getLayerMask(first);
+        for (std::size_t y = first; y < last; y++) {
+            const layer_mask above =
+                y + 1 < chunkHeight ? chunk->getLayerMask(y + 1) : 0;
+
+            // Neighbours in the layer, then in the neighbouring chunks
+            const layer_mask right =
+                ((current >> 1) & ~column_mask(chunkWidth - 1)) |
+                getApron(neighbours, 0, y);
+            const layer_mask left =
+                ((current << 1) & ~column_mask(0)) | getApron(neighbours, 1, y);
+            const layer_mask back =
+                (current >> chunkWidth) | getApron(neighbours, 2, y);
+            const layer_mask front = ((current << chunkWidth) & full_layer) |
+                                     getApron(neighbours, 3, y);
+
+            f(current & ~right, y, FaceKind::Right);
+            f(current & ~above, y, FaceKind::Top);
+            f(current & ~back, y, FaceKind::Back);
+            f(current & ~left, y, FaceKind::Left);
+            f(current & ~below, y, FaceKind::Bottom);
+            f(current & ~front, y, FaceKind::Front);
+
+            below = current;
+            current = above;
+        }
+    }
+
+    // Flood fills the air of the section a whole layer at a time, one air
+    // component after the other, and connects the faces each one touches
+    [[nodiscard]] section_visibility sectionVisibility(
+        std::size_t section) const {
+        if (chunk->isSectionEmpty(section)) return section_visibility::all();
+        if (chunk->isSectionFull(section)) return {};
+
+        std::array<layer_mask, chunkSectionHeight> air{};
+        std::array<layer_mask, chunkSectionHeight> unseen{};
+        for (std::size_t y = 0; y < chunkSectionHeight; y++)
+            air[y] = unseen[y] =
+                ~chunk->getLayerMask(section * chunkSectionHeight + y) &
+                full_layer;
+
+        const std::size_t last = chunkWidth - 1;
+        section_visibility res;
+        std::array<layer_mask, chunkSectionHeight> component{};
+        for (std::size_t seed = 0; seed < chunkSectionHeight; seed++) {
+            while (unseen[seed] != 0) {
+                component.fill(0);
+                component[seed] = layer_mask{1}
+                                  << std::countr_zero(unseen[seed]);
+
+                bool grown = true;
+                while (grown) {
+                    grown = false;
+                    for (std::size_t y = 0; y < chunkSectionHeight; y++) {
+                        const layer_mask current = component[y];
+                        layer_mask next =
+                            current | ((current >> 1) & ~column_mask(last)) |
+                            ((current << 1) & ~column_mask(0)) |
+                            (current >> chunkWidth) |
+                            ((current << chunkWidth) & full_layer);
+                        if (y > 0) next |= component[y - 1];
+                        if (y + 1 < chunkSectionHeight)
+                            next |= component[y + 1];
+                        next &= air[y];
+                        if (next != current) {
+                            component[y] = next;
+                            grown = true;
+                        }
+                    }
+                }
+
+                face_mask faces = 0;
+                for (std::size_t y = 0; y < chunkSectionHeight; y++) {
+                    const layer_mask mask = component[y];
+                    unseen[y] &= ~mask;
+                    if (mask == 0) continue;
+                    if (y == 0) faces |= faceMaskOf(FaceKind::Bottom);
+                    if (y == chunkSectionHeight - 1)
+                        faces |= faceMaskOf(FaceKind::Top);
+                    if ((mask & column_mask(last)) != 0)
+                        faces |= faceMaskOf(FaceKind::Right);
+                    if ((mask & column_mask(0)) != 0)
+                        faces |= faceMaskOf(FaceKind::Left);
+                    if ((mask & row_mask(last)) != 0)
+                        faces |= faceMaskOf(FaceKind::Back);
+                    if ((mask & row_mask(0)) != 0)
+                        faces |= faceMaskOf(FaceKind::Front);
+                }
+                res.connect(faces);
+            }
+        }
+        return res;
+    }
+
+    // Merges the visible faces of each plane of the layers from first to
+    // last, excluded, into rectangles
+    void simplifyGreedy(const chunk_neighbours& neighbours, std::size_t first,
+                        std::size_t last, mesh_type& out) const {
+        if (first >= last) return;
+        const std::size_t layers = last - first;
+
+        scratch_arena<greedy_scratch> scratch;
+        auto& visible = scratch->visible;
+        for (auto& masks : visible) masks.assign(layers, 0);
+        forEachVisibleFaces(
+            neighbours, first, last,
+            [&](layer_mask mask, std::size_t y, FaceKind kind) {
+                visible[static_cast<std::size_t>(kind)][y - first] = mask;
+            });
+
+        auto& plane = scratch->plane;
+        auto merge = [&](FaceKind kind, int normal_axis, int a_axis,
+                         int b_axis) {
+            const auto& masks = visible[static_cast<std::size_t>(kind)];
+            const std::size_t planes = normal_axis == 1 ? layers : chunkWidth;
+            const std::size_t b_size = b_axis == 1 ? layers : chunkWidth;
+            for (std::size_t p = 0; p < planes; p++) {
+                auto to_coords = [&](std::size_t a, std::size_t b) {
+                    block_chunk_coord coords{};
+                    coords[normal_axis] = p;
+                    coords[a_axis] = a;
+                    coords[b_axis] = b;
+                    coords[1] += first;
+                    return coords;
+                };
+
+                // Texture of the visible faces of the plane, -1 elsewhere
+                plane.assign(chunkWidth * b_size, -1);
+                for (std::size_t b = 0; b < b_size; b++) {
+                    for (std::size_t a = 0; a < chunkWidth; a++) {
+                        auto coords = to_coords(a, b);
+                        const auto bit = coords[0] + chunkWidth * coords[2];
+                        if ((masks[coords[1] - first] >> bit & 1) == 0)
+                            continue;
+                        plane[a + chunkWidth * b] = static_cast<int>(
+                            chunk->getBlockTexture(coords, kind));
+                    }
+                }
+
+                mergePlane(plane, b_size,
+                           [&](std::size_t a, std::size_t b, std::size_t width,
+                               std::size_t height, int texture) {
+                               math::vec3f size{1, 1, 1};
+                               size[a_axis] = static_cast<float>(width);
+                               size[b_axis] = static_cast<float>(height);
+                               out.addBlockFace(
+                                   to_coords(a, b), kind,
+                                   static_cast<BlockTexture>(texture), size);
+                           });
+            }
+        };
+
+        // x is 0, y is 1, z is 2
+        merge(FaceKind::Top, 1, 0, 2);
+        merge(FaceKind::Bottom, 1, 0, 2);
+        merge(FaceKind::Left, 0, 2, 1);
+        merge(FaceKind::Right, 0, 2, 1);
+        merge(FaceKind::Front, 2, 0, 1);
+        merge(FaceKind::Back, 2, 0, 1);
+    }
+
+    // Greedy rectangle decomposition of a chunkWidth x b_size plane of
+    // textures, -1 being no face. The plane is consumed. Calls
+    // emit(a, b, width, height, texture) for every rectangle
+    template <typename F>
+    static void mergePlane(std::vector<int>& plane, std::size_t b_size,
+                           F&& emit) {
+        auto at = [&](std::size_t a, std::size_t b) -> int& {
+            return plane[a + chunkWidth * b];
+        };
+
+        for (std::size_t b = 0; b < b_size; b++) {
+            for (std::size_t a = 0; a < chunkWidth; a++) {
+                const int texture = at(a, b);
+                if (texture < 0) continue;
+
+                std::size_t width = 1;
+                while (a + width < chunkWidth && at(a + width, b) == texture)
+                    width++;
+
+                std::size_t height = 1;
+                for (; b + height < b_size; height++) {
+                    bool same = true;
+                    for (std::size_t i = a; i < a + width && same; i++)
+                        same = at(i, b + height) == texture;
+                    if (!same) break;
+                }
+
+                for (std::size_t j = b; j < b + height; j++)
+                    for (std::size_t i = a; i < a + width; i++) at(i, j) = -1;
+
+                emit(a, b, width, height, texture);
+            }
+        }
+    }
+
+    // Solid blocks of the neighbour i that touch the layer y of this chunk,
+    // at the position of the block of this chunk they touch
+    static layer_mask getApron(const chunk_neighbours& neighbours,
+                               std::size_t i, std::size_t y) {
+        if (!neighbours[i]) return 0;
+
+        const layer_mask mask = neighbours[i]->getLayerMask(y);
+        const std::size_t last = chunkWidth - 1;
+        switch (i) {
+            case 0:
+                return (mask & column_mask(0)) << last;
+            case 1:
+                return (mask & column_mask(last)) >> last;
+            case 2:
+                return (mask & row_mask(0)) << (chunkWidth * last);
+            case 3:
+            default:
+                return (mask & row_mask(last)) >> (chunkWidth * last);
+        }
+    }
+
+    // Block of a neighbouring chunk behind the face kind of the block at
+    // coords, air if there is none
+    static BlockData getOutsideBlock(const chunk_neighbours& neighbours,
+                                     block_chunk_coord coords, FaceKind kind) {
+        auto [x, y, z] = coords.data;
+        const std::size_t last = chunkWidth - 1;
+        auto get = [&](std::size_t i, std::size_t nx,
+                       std::size_t nz) -> BlockData {
+            if (!neighbours[i]) return {};
+            return neighbours[i]->getBlock({nx, y, nz});
+        };
+
+        switch (kind) {
+            case FaceKind::Right:
+                if (x == last) return get(0, 0, z);
+                break;
+            case FaceKind::Left:
+                if (x == 0) return get(1, last, z);
+                break;
+            case FaceKind::Back:
+                if (z == last) return get(2, x, 0);
+                break;
+            case FaceKind::Front:
+                if (z == 0) return get(3, x, last);
+                break;
+            default:
+                break;
+        }
+        return {};
+    }
+
+    // Bits of the blocks of a layer with this z
+    static constexpr layer_mask row_mask(std::size_t z) {
+        return (full_layer >> (chunkWidth * (chunkWidth - 1)))
+               << (chunkWidth * z);
+    }
+
+    // Bits of the blocks of a layer with this x
+    static constexpr layer_mask column_mask(std::size_t x) {
+        layer_mask mask = 0;
+        for (std::size_t z = 0; z < chunkWidth; z++)
+            mask |= layer_mask{1} << (x + chunkWidth * z);
+        return mask;
+    }
+
+    void addLayerFaces(layer_mask visible, std::size_t y, FaceKind kind,
+                       mesh_type& out) const {
+        while (visible != 0) {
+            const auto i = static_cast<std::size_t>(std::countr_zero(visible));
+            visible &= visible - 1;
+
+            block_chunk_coord coords{i % chunkWidth, y, i / chunkWidth};
+            out.addBlockFace(coords, kind,
+                              chunk->getBlockTexture(coords, kind));
+        }
+    }
+
     // returns all 6 neighbours of coords in chunk. If neighbours is out
     // of bounds, will return coords
     // Right
@@ -171,7 +833,12 @@ class ChunkSimplifyerProxy {
         return neighbours;
     }
 
-    Logger log{Logger::get({"ChunkSimplifyer"})};
+    std::shared_ptr<const Chunk> chunk;
+    MeshingMode meshing_mode;
+    std::array<bool, 4> meshed_with{};
+    // First quad of each section in the mesh, the last one is the end
+    std::array<std::size_t, chunkSectionCount + 1> section_quads{};
+    chunk_visibility visibility{};
 };
 
 #endif  // !CHUNK_H_
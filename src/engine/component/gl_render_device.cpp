@@ -0,0 +1,341 @@
+#include "gl_render_device.h"
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+GLuint GLRenderDevice::createBuffer() {
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    return buffer;
+}
+
+void GLRenderDevice::deleteBuffer(GLuint buffer) {
+    glDeleteBuffers(1, &buffer);
+}
+
+void GLRenderDevice::bindBuffer(GLenum target, GLuint buffer) {
+    glBindBuffer(target, buffer);
+}
+
+void GLRenderDevice::bindBufferBase(GLenum target, GLuint index,
+                                    GLuint buffer) {
+    glBindBufferBase(target, index, buffer);
+}
+
+void GLRenderDevice::bufferData(GLenum target, std::size_t bytes,
+                                const void* data, GLenum usage) {
+    glBufferData(target, static_cast<GLsizeiptr>(bytes), data, usage);
+}
+
+void GLRenderDevice::bufferSubData(GLenum target, std::size_t offset,
+                                   std::size_t bytes, const void* data) {
+    glBufferSubData(target, static_cast<GLintptr>(offset),
+                    static_cast<GLsizeiptr>(bytes), data);
+}
+
+void GLRenderDevice::copyBufferSubData(GLenum read_target, GLenum write_target,
+                                       std::size_t read_offset,
+                                       std::size_t write_offset,
+                                       std::size_t bytes) {
+    glCopyBufferSubData(read_target, write_target,
+                        static_cast<GLintptr>(read_offset),
+                        static_cast<GLintptr>(write_offset),
+                        static_cast<GLsizeiptr>(bytes));
+}
+
+GLuint GLRenderDevice::createVertexArray() {
+    GLuint vertex_array = 0;
+    glGenVertexArrays(1, &vertex_array);
+    return vertex_array;
+}
+
+void GLRenderDevice::deleteVertexArray(GLuint vertex_array) {
+    glDeleteVertexArrays(1, &vertex_array);
+}
+
+void GLRenderDevice::bindVertexArray(GLuint vertex_array) {
+    glBindVertexArray(vertex_array);
+}
+
+void GLRenderDevice::vertexAttribPointer(GLuint index, GLint size, GLenum type,
+                                         bool integer, std::size_t stride,
+                                         std::size_t offset) {
+    const auto* pointer = reinterpret_cast<const void*>(  // NOLINT
+        static_cast<std::uintptr_t>(offset));
+    if (integer)
+        glVertexAttribIPointer(index, size, type, static_cast<GLsizei>(stride),
+                               pointer);
+    else
+        glVertexAttribPointer(index, size, type, GL_FALSE,
+                              static_cast<GLsizei>(stride), pointer);
+}
+
+void GLRenderDevice::enableVertexAttribArray(GLuint index) {
+    glEnableVertexAttribArray(index);
+}
+
+void GLRenderDevice::vertexAttribDivisor(GLuint index, GLuint divisor) {
+    glVertexAttribDivisor(index, divisor);
+}
+
+GLuint GLRenderDevice::createProgram(const std::string& vertex_source,
+                                     const std::string& fragment_source) {
+    if (!program_cache)
+        return compileProgram(vertex_source, fragment_source, false);
+
+    using clock = std::chrono::steady_clock;
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    const auto key =
+        ProgramBinaryCache::key(driverString(), vertex_source, fragment_source);
+
+    const auto load_begin = clock::now();
+    if (const auto binary = program_cache->load(key)) {
+        if (const GLuint program = loadProgram(*binary)) {
+            const auto load_time =
+                duration_cast<microseconds>(clock::now() - load_begin);
+            profiler_log << LogLevel::Info << "Program binary cache hit: "
+                         << load_time.count() << "µs instead of "
+                         << binary->compile_time.count() << "µs, saved "
+                         << (binary->compile_time - load_time).count() << "µs";
+            return program;
+        }
+        profiler_log << LogLevel::Info
+                     << "Program binary cache entry refused by the driver";
+    }
+
+    const auto compile_begin = clock::now();
+    const GLuint program = compileProgram(vertex_source, fragment_source, true);
+    const auto compile_time =
+        duration_cast<microseconds>(clock::now() - compile_begin);
+    profiler_log << LogLevel::Info << "Program binary cache miss: compiled in "
+                 << compile_time.count() << "µs";
+
+    if (auto binary = getProgramBinary(program)) {
+        binary->compile_time = compile_time;
+        program_cache->save(key, *binary);
+    }
+    return program;
+}
+
+GLuint GLRenderDevice::loadProgram(const program_binary& binary) {
+    const GLuint program = glCreateProgram();
+    glProgramBinary(program, binary.format, binary.data.data(),
+                    static_cast<GLsizei>(binary.data.size()));
+
+    int linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked == GL_TRUE) return program;
+    glDeleteProgram(program);
+    return 0;
+}
+
+std::optional<program_binary> GLRenderDevice::getProgramBinary(
+    GLuint program) {
+    // No binary at all when the driver supports no binary format
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return {};
+
+    program_binary binary;
+    binary.data.resize(static_cast<std::size_t>(length));
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data.data());
+    binary.data.resize(static_cast<std::size_t>(length));
+    binary.format = format;
+    return binary;
+}
+
+std::string GLRenderDevice::driverString() {
+    std::string driver;
+    for (const GLenum name :
+         {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION}) {
+        const auto* value =
+            reinterpret_cast<const char*>(glGetString(name));  // NOLINT
+        if (value != nullptr) driver += value;
+        driver += '\n';
+    }
+    return driver;
+}
+
+GLuint GLRenderDevice::compileProgram(const std::string& vertex_source,
+                                      const std::string& fragment_source,
+                                      bool binary_retrievable) {
+    auto compileShader = [](const std::string& source, GLenum kind) {
+        const GLuint shader = glCreateShader(kind);
+        const char* csource = source.c_str();
+        glShaderSource(shader, 1, &csource, nullptr);
+        glCompileShader(shader);
+        return shader;
+    };
+
+    auto infoLog = [](GLuint object, auto get_iv, auto get_log) {
+        int max_length = 0;
+        get_iv(object, GL_INFO_LOG_LENGTH, &max_length);
+        std::string err_str;
+        err_str.resize(static_cast<std::size_t>(max_length));
+        get_log(object, max_length, &max_length, err_str.data());
+        return err_str;
+    };
+
+    auto checkShader = [&](GLuint shader, const char* what) {
+        int compiled = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+        if (compiled == GL_TRUE) return;
+
+        log << LogLevel::Error << "Fatal error in " << what;
+        auto err_str = infoLog(shader, glGetShaderiv, glGetShaderInfoLog);
+        glDeleteShader(shader);
+        throw std::runtime_error(err_str);
+    };
+
+    const GLuint vertex_shader = compileShader(vertex_source, GL_VERTEX_SHADER);
+    checkShader(vertex_shader, "vertex shader");
+    const GLuint fragment_shader =
+        compileShader(fragment_source, GL_FRAGMENT_SHADER);
+    try {
+        checkShader(fragment_shader, "fragment shader");
+    } catch (...) {
+        glDeleteShader(vertex_shader);
+        throw;
+    }
+
+    const GLuint program = glCreateProgram();
+    if (binary_retrievable)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                            GL_TRUE);
+    glAttachShader(program, vertex_shader);
+    glAttachShader(program, fragment_shader);
+    glLinkProgram(program);
+
+    // The program keeps what it needs of them
+    glDetachShader(program, vertex_shader);
+    glDetachShader(program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+
+    int linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE) {
+        log << LogLevel::Error << "Fatal error in shader linking";
+        auto err_str = infoLog(program, glGetProgramiv, glGetProgramInfoLog);
+        glDeleteProgram(program);
+        throw std::runtime_error(err_str);
+    }
+    return program;
+}
+
+void GLRenderDevice::deleteProgram(GLuint program) {
+    glDeleteProgram(program);
+}
+
+void GLRenderDevice::useProgram(GLuint program) { glUseProgram(program); }
+
+namespace {
+// Locations of the active attributes or uniforms of the program
+template <typename GetActive, typename GetLocation>
+RenderDevice::locations activeLocations(GLuint program, GLenum count_kind,
+                                        GLenum max_length_kind,
+                                        GetActive get_active,
+                                        GetLocation get_location) {
+    GLint count = 0;
+    GLint max_length = 0;
+    glGetProgramiv(program, count_kind, &count);
+    glGetProgramiv(program, max_length_kind, &max_length);
+
+    RenderDevice::locations res;
+    std::string name;
+    for (GLint i = 0; i < count; i++) {
+        name.resize(static_cast<std::size_t>(max_length));
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        get_active(program, static_cast<GLuint>(i), max_length, &length,
+                   &size, &type, name.data());
+        name.resize(static_cast<std::size_t>(length));
+        // Uniforms of blocks have no location
+        const GLint location = get_location(program, name.c_str());
+        if (location >= 0) res.emplace_back(name, location);
+    }
+    return res;
+}
+}  // namespace
+
+RenderDevice::locations GLRenderDevice::getAttribLocations(GLuint program) {
+    return activeLocations(program, GL_ACTIVE_ATTRIBUTES,
+                           GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, glGetActiveAttrib,
+                           glGetAttribLocation);
+}
+
+RenderDevice::locations GLRenderDevice::getUniformLocations(GLuint program) {
+    return activeLocations(program, GL_ACTIVE_UNIFORMS,
+                           GL_ACTIVE_UNIFORM_MAX_LENGTH, glGetActiveUniform,
+                           glGetUniformLocation);
+}
+
+void GLRenderDevice::uniform1i(GLint location, GLint value) {
+    glUniform1i(location, value);
+}
+
+GLuint GLRenderDevice::createTexture() {
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    return texture;
+}
+
+void GLRenderDevice::deleteTexture(GLuint texture) {
+    glDeleteTextures(1, &texture);
+}
+
+void GLRenderDevice::bindTexture(GLenum target, GLuint texture) {
+    glBindTexture(target, texture);
+}
+
+void GLRenderDevice::texParameteri(GLenum target, GLenum name, GLint value) {
+    glTexParameteri(target, name, value);
+}
+
+void GLRenderDevice::pixelStorei(GLenum name, GLint value) {
+    glPixelStorei(name, value);
+}
+
+void GLRenderDevice::texImage3D(GLenum target, GLint level,
+                                GLint internal_format, GLsizei width,
+                                GLsizei height, GLsizei depth, GLenum format,
+                                GLenum type, const void* data,
+                                std::size_t /*bytes*/) {
+    glTexImage3D(target, level, internal_format, width, height, depth, 0,
+                 format, type, data);
+}
+
+void GLRenderDevice::texSubImage3D(GLenum target, GLint level, GLint x,
+                                   GLint y, GLint z, GLsizei width,
+                                   GLsizei height, GLsizei depth,
+                                   GLenum format, GLenum type,
+                                   const void* data, std::size_t /*bytes*/) {
+    glTexSubImage3D(target, level, x, y, z, width, height, depth, format, type,
+                    data);
+}
+
+void GLRenderDevice::enable(GLenum capability) { glEnable(capability); }
+
+void GLRenderDevice::clearColor(float r, float g, float b, float a) {
+    glClearColor(r, g, b, a);
+}
+
+void GLRenderDevice::clear(GLbitfield mask) { glClear(mask); }
+
+void GLRenderDevice::multiDrawElementsIndirect(GLenum mode, GLenum type,
+                                               std::size_t indirect_offset,
+                                               GLsizei draw_count) {
+    glMultiDrawElementsIndirect(
+        mode, type,
+        reinterpret_cast<const void*>(  // NOLINT
+            static_cast<std::uintptr_t>(indirect_offset)),
+        draw_count, 0);
+}
@@ -0,0 +1,93 @@
+#ifndef GL_RENDER_DEVICE_H_
+#define GL_RENDER_DEVICE_H_
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "../data/program_binary_cache.h"
+#include "../utils/logging.h"
+#include "render_device.h"
+
+// Forwards everything to OpenGL, the context must be current
+class GLRenderDevice final : public RenderDevice {
+   public:
+    GLRenderDevice() = default;
+    // The linked programs are kept in program_cache_directory, and loaded
+    // from there rather than compiled when the sources and the driver are
+    // the same, see ProgramBinaryCache
+    explicit GLRenderDevice(const fs::path& program_cache_directory)
+        : program_cache(std::in_place, program_cache_directory) {}
+
+    GLuint createBuffer() override;
+    void deleteBuffer(GLuint buffer) override;
+    void bindBuffer(GLenum target, GLuint buffer) override;
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer) override;
+    void bufferData(GLenum target, std::size_t bytes, const void* data,
+                    GLenum usage) override;
+    void bufferSubData(GLenum target, std::size_t offset, std::size_t bytes,
+                       const void* data) override;
+    void copyBufferSubData(GLenum read_target, GLenum write_target,
+                           std::size_t read_offset, std::size_t write_offset,
+                           std::size_t bytes) override;
+
+    GLuint createVertexArray() override;
+    void deleteVertexArray(GLuint vertex_array) override;
+    void bindVertexArray(GLuint vertex_array) override;
+    void vertexAttribPointer(GLuint index, GLint size, GLenum type,
+                             bool integer, std::size_t stride,
+                             std::size_t offset) override;
+    void enableVertexAttribArray(GLuint index) override;
+    void vertexAttribDivisor(GLuint index, GLuint divisor) override;
+
+    GLuint createProgram(const std::string& vertex_source,
+                         const std::string& fragment_source) override;
+    void deleteProgram(GLuint program) override;
+    void useProgram(GLuint program) override;
+    locations getAttribLocations(GLuint program) override;
+    locations getUniformLocations(GLuint program) override;
+    void uniform1i(GLint location, GLint value) override;
+
+    GLuint createTexture() override;
+    void deleteTexture(GLuint texture) override;
+    void bindTexture(GLenum target, GLuint texture) override;
+    void texParameteri(GLenum target, GLenum name, GLint value) override;
+    void pixelStorei(GLenum name, GLint value) override;
+    void texImage3D(GLenum target, GLint level, GLint internal_format,
+                    GLsizei width, GLsizei height, GLsizei depth,
+                    GLenum format, GLenum type, const void* data,
+                    std::size_t bytes) override;
+    void texSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z,
+                       GLsizei width, GLsizei height, GLsizei depth,
+                       GLenum format, GLenum type, const void* data,
+                       std::size_t bytes) override;
+
+    void enable(GLenum capability) override;
+    void clearColor(float r, float g, float b, float a) override;
+    void clear(GLbitfield mask) override;
+    void multiDrawElementsIndirect(GLenum mode, GLenum type,
+                                   std::size_t indirect_offset,
+                                   GLsizei draw_count) override;
+
+   private:
+    // Compiles and links the sources, binary_retrievable if the binary is to
+    // be saved
+    GLuint compileProgram(const std::string& vertex_source,
+                          const std::string& fragment_source,
+                          bool binary_retrievable);
+    // 0 if the driver refuses the binary
+    static GLuint loadProgram(const program_binary& binary);
+    static std::optional<program_binary> getProgramBinary(GLuint program);
+    // Vendor, renderer and version of the context
+    static std::string driverString();
+
+    std::optional<ProgramBinaryCache> program_cache;
+    Logger log = Logger::get({"Shader"});
+    Logger profiler_log =
+        Logger::get({.category = "Profiler", .level = LogLevel::Info});
+};
+
+#endif  // !GL_RENDER_DEVICE_H_
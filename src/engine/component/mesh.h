@@ -1,7 +1,9 @@
 #ifndef MESH_H_
 #define MESH_H_
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <vector>
 
@@ -10,97 +12,194 @@
 #include "../utils/mat.h"
 #include "../utils/mat_opengl.h"
 
+enum class FaceKind { Top, Bottom, Front, Back, Left, Right };
+const std::size_t faceKindCount = 6;
+
+// Meshes are made of quads of 4 vertices, all drawn with the same indices
+const std::size_t verticesPerQuad = 4;
+const std::size_t indicesPerQuad = 6;
+using quad_index = std::uint32_t;
+
+// Indices of the two triangles of quad_count consecutive quads: 0 1 2, 0 3 1
+inline std::vector<quad_index> quadIndices(std::size_t quad_count) {
+    std::vector<quad_index> indices;
+    indices.reserve(quad_count * indicesPerQuad);
+    for (std::size_t quad = 0; quad < quad_count; quad++) {
+        const auto first = static_cast<quad_index>(quad * verticesPerQuad);
+        for (quad_index corner : {0, 1, 2, 0, 3, 1})
+            indices.push_back(first + corner);
+    }
+    return indices;
+}
+
+// 24 bytes per vertex, everything is explicit
 struct BlockVertex {
     math::vec3f position;
     math::vec2f textpos;
     BlockTexture textid;
-};
-
-enum class FaceKind { Top, Bottom, Front, Back, Left, Right };
-
-class MeshChunk {
-   public:
-    MeshChunk() { updateModelMatrix(); }
 
-    static constexpr std::array layout{ 
+    static constexpr bool is_packed = false;
+    static constexpr std::array layout{
         LayoutItem{"in_position", LayoutType::Float, 3},
         LayoutItem{"in_texposition", LayoutType::Float, 2},
         LayoutItem{"in_textid", LayoutType::Int, 1},
     };
 
-    // position is left top corner
+    static BlockVertex make(math::vec3f position, math::vec2f textpos,
+                            BlockTexture texture, FaceKind /*kind*/) {
+        return {position, textpos, texture};
+    }
+};
+
+// 4 bytes per vertex, decoded by asset/shader/base.vert. From the low bits:
+//   - x and z, chunk local, 5 bits each
+//   - y, 9 bits
+//   - the FaceKind, 3 bits
+//   - the BlockTexture, 8 bits
+// The texture coordinates are not stored: they are the position along the
+// axes of the face, the texture repeats once per block
+struct PackedBlockVertex {
+    std::uint32_t data;
+
+    static constexpr bool is_packed = true;
+    static constexpr std::array layout{
+        LayoutItem{"in_packed", LayoutType::Uint, 1},
+    };
+
+    static constexpr std::uint32_t max_horizontal = (1U << 5U) - 1;
+    static constexpr std::uint32_t max_height = (1U << 9U) - 1;
+    static constexpr std::uint32_t max_texture = (1U << 8U) - 1;
+
+    static PackedBlockVertex make(math::vec3f position, math::vec2f /*textpos*/,
+                                  BlockTexture texture, FaceKind kind) {
+        auto coord = [&](int i) {
+            return static_cast<std::uint32_t>(position[i] + 0.5F);
+        };
+        return {coord(0) | coord(2) << 5U | coord(1) << 10U |
+                static_cast<std::uint32_t>(kind) << 19U |
+                static_cast<std::uint32_t>(texture) << 22U};
+    }
+
+    [[nodiscard]] math::vec3f position() const {
+        return {static_cast<float>(data & max_horizontal),
+                static_cast<float>(data >> 10U & max_height),
+                static_cast<float>(data >> 5U & max_horizontal)};
+    }
+    [[nodiscard]] FaceKind face() const {
+        return static_cast<FaceKind>(data >> 19U & 7U);
+    }
+    [[nodiscard]] BlockTexture texture() const {
+        return static_cast<BlockTexture>(data >> 22U & max_texture);
+    }
+};
+
+template <typename Vertex>
+class BasicMeshChunk {
+   public:
+    using vertex_type = Vertex;
+
+    BasicMeshChunk() { updateModelMatrix(); }
+
+    static constexpr auto layout = Vertex::layout;
+
+    // position is left top corner. size is the size of the face in blocks,
+    // for merged faces: the texture is repeated once per block.
+    // A face is 4 vertices, drawn with the indices of quadIndices
     void addBlockFace(math::vec3f coords, FaceKind kind,
-                      BlockTexture texture_id) {
+                      BlockTexture texture_id,
+                      math::vec3f size = {1, 1, 1}) {
+        // Axes along which the texture coordinates go
+        int s_axis = 0;
+        int t_axis = 1;
+        auto vertex = [&](math::vec3f offset, math::vec2f textpos) {
+            for (int i = 0; i < 3; i++) offset[i] *= size[i];
+            textpos[0] *= size[s_axis];
+            textpos[1] *= size[t_axis];
+            vertices.push_back(
+                Vertex::make(coords + offset, textpos, texture_id, kind));
+        };
+
         // clang-format off
         switch (kind) {
             case FaceKind::Front:
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 0, 0}, {0, 1}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 1, 0}, {1, 0}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 0, 0}, {1, 1}, texture_id});
-
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 0, 0}, {0, 1}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 1, 0}, {0, 0}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 1, 0}, {1, 0}, texture_id});
+                vertex({ 0, 0, 0}, {0, 1});
+                vertex({ 1, 1, 0}, {1, 0});
+                vertex({ 1, 0, 0}, {1, 1});
+                vertex({ 0, 1, 0}, {0, 0});
                 break;
             case FaceKind::Left:
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 0, 0}, {1, 1}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 1, 1}, {0, 0}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 1, 0}, {1, 0}, texture_id});
-
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 0, 0}, {1, 1}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 0, 1}, {0, 1}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 1, 1}, {0, 0}, texture_id});
+                s_axis = 2;
+                vertex({ 0, 0, 0}, {1, 1});
+                vertex({ 0, 1, 1}, {0, 0});
+                vertex({ 0, 1, 0}, {1, 0});
+                vertex({ 0, 0, 1}, {0, 1});
                 break;
             case FaceKind::Bottom:
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 0, 0}, {0, 0}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 0, 1}, {1, 1}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 0, 1}, {0, 1}, texture_id});
-
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 0, 0}, {0, 0}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 0, 0}, {1, 0}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 0, 1}, {1, 1}, texture_id});
+                t_axis = 2;
+                vertex({ 0, 0, 0}, {0, 0});
+                vertex({ 1, 0, 1}, {1, 1});
+                vertex({ 0, 0, 1}, {0, 1});
+                vertex({ 1, 0, 0}, {1, 0});
                 break;
             case FaceKind::Right:
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 1, 1}, {1, 0}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 0, 0}, {0, 1}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 1, 0}, {0, 0}, texture_id});
-
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 1, 1}, {1, 0}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 0, 1}, {1, 1}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 0, 0}, {0, 1}, texture_id});
+                s_axis = 2;
+                vertex({ 1, 1, 1}, {1, 0});
+                vertex({ 1, 0, 0}, {0, 1});
+                vertex({ 1, 1, 0}, {0, 0});
+                vertex({ 1, 0, 1}, {1, 1});
                 break;
             case FaceKind::Back:
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 1, 1}, {0, 0}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 1, 1}, {1, 0}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 0, 1}, {1, 1}, texture_id});
-
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 1, 1}, {0, 0}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 0, 1}, {1, 1}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 0, 1}, {0, 1}, texture_id});
+                vertex({ 1, 1, 1}, {0, 0});
+                vertex({ 0, 0, 1}, {1, 1});
+                vertex({ 1, 0, 1}, {0, 1});
+                vertex({ 0, 1, 1}, {1, 0});
                 break;
             case FaceKind::Top:
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 1, 1}, {1, 0}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 1, 0}, {0, 1}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 1, 1}, {0, 0}, texture_id});
-
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 1, 1}, {1, 0}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 1, 1, 0}, {1, 1}, texture_id});
-                vertices.push_back(BlockVertex{coords + math::vec3f{ 0, 1, 0}, {0, 1}, texture_id});
+                t_axis = 2;
+                vertex({ 1, 1, 1}, {1, 0});
+                vertex({ 0, 1, 0}, {0, 1});
+                vertex({ 0, 1, 1}, {0, 0});
+                vertex({ 1, 1, 0}, {1, 1});
                 break;
         }
         // clang-format on
     }
 
+    void clear() { vertices.clear(); }
+
+    // Copies the vertices of other, the memory used is exactly their size
+    void assignVertices(const BasicMeshChunk& other) {
+        vertices.assign(other.vertices.begin(), other.vertices.end());
+        vertices.shrink_to_fit();
+    }
+
+    // Replaces the count quads from first on with the ones of quads
+    void replaceQuads(std::size_t first, std::size_t count,
+                      const BasicMeshChunk& quads) {
+        const auto begin = vertices.begin() + static_cast<std::ptrdiff_t>(
+                                                  first * verticesPerQuad);
+        const auto end =
+            vertices.erase(begin, begin + static_cast<std::ptrdiff_t>(
+                                              count * verticesPerQuad));
+        vertices.insert(end, quads.vertices.begin(), quads.vertices.end());
+    }
+
     void updateModelMatrix() { model_matrix = math::scale(scaling_factor); }
     [[nodiscard]] const math::mat4f& getModelMatrix() const { return model_matrix; }
-    [[nodiscard]] const BlockVertex* data() const { return vertices.data(); }
+    [[nodiscard]] const Vertex* data() const { return vertices.data(); }
     [[nodiscard]] std::size_t size() const { return vertices.size(); }
-    [[nodiscard]] std::size_t bytes() const { return sizeof(BlockVertex) * size(); }
+    [[nodiscard]] std::size_t quadCount() const {
+        return vertices.size() / verticesPerQuad;
+    }
+    [[nodiscard]] std::size_t bytes() const { return sizeof(Vertex) * size(); }
 
    private:
-    std::vector<BlockVertex> vertices{};
+    std::vector<Vertex> vertices{};
     float scaling_factor = 1;
     math::mat4f model_matrix = math::identity<float, 4>();
 };
 
+using MeshChunk = BasicMeshChunk<BlockVertex>;
+using PackedMeshChunk = BasicMeshChunk<PackedBlockVertex>;
+
 #endif  // !MESH_H_
@@ -0,0 +1,141 @@
+#include "mesh_arena.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "mesh.h"
+
+MeshArena::MeshArena(RenderDevice& device, const Shader& shader,
+                     Layout layout, std::size_t vertex_size)
+    : device(device),
+      shader(shader),
+      layout(std::move(layout)),
+      vertex_size(vertex_size),
+      vao(device.createVertexArray()),
+      vertex_buffer(device.createBuffer()),
+      origin_buffer(device.createBuffer()),
+      command_buffer(device.createBuffer()),
+      quad_indices(device) {
+    device.bindVertexArray(vao);
+    device.bindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    device.bufferData(GL_ARRAY_BUFFER, initial_capacity * vertex_size, nullptr,
+                      GL_DYNAMIC_DRAW);
+    allocator.grow(initial_capacity);
+    bindVertexBuffer();
+
+    // One origin per draw, picked by its base instance
+    const GLint origin = shader.getAttribLocation("in_origin");
+    if (origin >= 0) {
+        const auto index = static_cast<GLuint>(origin);
+        device.bindBuffer(GL_ARRAY_BUFFER, origin_buffer);
+        device.vertexAttribPointer(index, 2, GL_INT, true, 0, 0);
+        device.vertexAttribDivisor(index, 1);
+        device.enableVertexAttribArray(index);
+    }
+
+    quad_indices.bind(1);
+    device.bindVertexArray(0);
+}
+
+MeshArena::~MeshArena() {
+    device.deleteBuffer(command_buffer);
+    device.deleteBuffer(origin_buffer);
+    device.deleteBuffer(vertex_buffer);
+    device.deleteVertexArray(vao);
+}
+
+MeshArena::Allocation MeshArena::upload(const void* vertices,
+                                        std::size_t count) {
+    if (count == 0) return {this, 0, 0};
+
+    Allocation allocation{this, allocate(count), count};
+    write(allocation.offset(), vertices, count);
+    return allocation;
+}
+
+void MeshArena::update(Allocation& allocation, const void* vertices,
+                       std::size_t count, std::size_t first) {
+    if (count > allocation.capacity()) {
+        // Edited meshes are likely to be edited again
+        Allocation moved{this, allocate(count + count / 2),
+                         count + count / 2};
+        allocation = std::move(moved);
+        first = 0;
+    }
+    if (first < count)
+        write(allocation.offset() + first,
+              static_cast<const std::byte*>(vertices) + first * vertex_size,
+              count - first);
+}
+
+void MeshArena::draw(const mesh_draw_list& draws) const {
+    if (draws.empty()) return;
+
+    device.bindVertexArray(vao);
+    device.bindBuffer(GL_ARRAY_BUFFER, origin_buffer);
+    device.bufferData(GL_ARRAY_BUFFER,
+                      draws.instances().size() * sizeof(mesh_origin),
+                      draws.instances().data(), GL_STREAM_DRAW);
+    device.bindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+    device.bufferData(GL_DRAW_INDIRECT_BUFFER,
+                      draws.commands().size() * sizeof(draw_elements_command),
+                      draws.commands().data(), GL_STREAM_DRAW);
+
+    device.multiDrawElementsIndirect(GL_TRIANGLES, QuadIndexBuffer::index_type,
+                                     0, static_cast<GLsizei>(draws.size()));
+    device.bindVertexArray(0);
+}
+
+std::size_t MeshArena::allocate(std::size_t count) {
+    auto offset = allocator.allocate(count);
+    if (!offset) {
+        grow(allocator.capacity() + count);
+        offset = allocator.allocate(count);
+    }
+
+    // Every draw starts at the first index
+    device.bindVertexArray(vao);
+    quad_indices.bind(count / verticesPerQuad);
+    device.bindVertexArray(0);
+    return *offset;
+}
+
+void MeshArena::release(std::size_t first_vertex, std::size_t count) {
+    if (count != 0) allocator.release(first_vertex, count);
+}
+
+void MeshArena::write(std::size_t first_vertex, const void* vertices,
+                      std::size_t count) const {
+    device.bindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    device.bufferSubData(GL_ARRAY_BUFFER, first_vertex * vertex_size,
+                         count * vertex_size, vertices);
+}
+
+void MeshArena::grow(std::size_t min_capacity) {
+    const std::size_t old_capacity = allocator.capacity();
+    const std::size_t new_capacity = std::max(2 * old_capacity, min_capacity);
+
+    const GLuint new_buffer = device.createBuffer();
+    device.bindBuffer(GL_COPY_WRITE_BUFFER, new_buffer);
+    device.bufferData(GL_COPY_WRITE_BUFFER, new_capacity * vertex_size,
+                      nullptr, GL_DYNAMIC_DRAW);
+    device.bindBuffer(GL_COPY_READ_BUFFER, vertex_buffer);
+    device.copyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                             old_capacity * vertex_size);
+
+    device.deleteBuffer(vertex_buffer);
+    vertex_buffer = new_buffer;
+    allocator.grow(new_capacity);
+
+    device.bindVertexArray(vao);
+    bindVertexBuffer();
+    device.bindVertexArray(0);
+}
+
+void MeshArena::bindVertexBuffer() const {
+    device.bindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    shader.useLayout(layout);
+}
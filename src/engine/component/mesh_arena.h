@@ -0,0 +1,117 @@
+#ifndef MESH_ARENA_H_
+#define MESH_ARENA_H_
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "../data/shader_layout.h"
+#include "../data_structure/draw_command_list.h"
+#include "../data_structure/range_allocator.h"
+#include "quad_index_buffer.h"
+#include "render_device.h"
+#include "shader.h"
+
+// Position of a mesh in the world, x and z in blocks
+using mesh_origin = std::array<std::int32_t, 2>;
+using mesh_draw_list = draw_command_list<mesh_origin>;
+
+// A single vertex buffer and a single vertex array for all the meshes of the
+// world, sub allocated with a range_allocator. The meshes are made of quads,
+// see quadIndices, and are all drawn by one glMultiDrawElementsIndirect.
+//
+// The shader reads the origin of the mesh of each draw from the instanced
+// attribute in_origin
+class MeshArena {
+   public:
+    // Vertices of the arena, given back on destruction. Empty when default
+    // constructed, an empty mesh still has an allocation of no vertex
+    class Allocation {
+       public:
+        Allocation() = default;
+        Allocation(const Allocation&) = delete;
+        Allocation& operator=(const Allocation&) = delete;
+        Allocation(Allocation&& other) noexcept { swap(other); }
+        Allocation& operator=(Allocation&& other) noexcept {
+            swap(other);
+            return *this;
+        }
+        ~Allocation() {
+            if (arena) arena->release(first_vertex, vertex_capacity);
+        }
+
+        explicit operator bool() const { return arena != nullptr; }
+        [[nodiscard]] std::size_t offset() const { return first_vertex; }
+        [[nodiscard]] std::size_t capacity() const { return vertex_capacity; }
+
+       private:
+        friend MeshArena;
+        void swap(Allocation& other) noexcept {
+            std::swap(arena, other.arena);
+            std::swap(first_vertex, other.first_vertex);
+            std::swap(vertex_capacity, other.vertex_capacity);
+        }
+
+        Allocation(MeshArena* arena, std::size_t first_vertex,
+                   std::size_t vertex_capacity)
+            : arena(arena),
+              first_vertex(first_vertex),
+              vertex_capacity(vertex_capacity) {}
+
+        MeshArena* arena = nullptr;
+        std::size_t first_vertex = 0;
+        std::size_t vertex_capacity = 0;
+    };
+
+    // The vertex attributes follow layout, vertices are vertex_size bytes
+    MeshArena(RenderDevice& device, const Shader& shader, Layout layout,
+              std::size_t vertex_size);
+    MeshArena(const MeshArena&) = delete;
+    MeshArena& operator=(const MeshArena&) = delete;
+    ~MeshArena();
+
+    // Room for count vertices, filled with vertices
+    Allocation upload(const void* vertices, std::size_t count);
+    // Uploads count vertices, the ones before first being already there. The
+    // allocation moves, with some room to grow, when they do not fit anymore
+    void update(Allocation& allocation, const void* vertices,
+                std::size_t count, std::size_t first = 0);
+
+    // The shader must be in use
+    void draw(const mesh_draw_list& draws) const;
+
+    [[nodiscard]] std::size_t capacity() const {
+        return allocator.capacity();
+    }
+    [[nodiscard]] std::size_t used() const { return allocator.used(); }
+
+   private:
+    // Offset of count free vertices, the buffer grows if there are none
+    std::size_t allocate(std::size_t count);
+    void release(std::size_t first_vertex, std::size_t count);
+    void write(std::size_t first_vertex, const void* vertices,
+               std::size_t count) const;
+    // Moves the vertices to a buffer of at least min_capacity vertices
+    void grow(std::size_t min_capacity);
+    // The vertex attributes read the current vertex buffer
+    void bindVertexBuffer() const;
+
+    static constexpr std::size_t initial_capacity = std::size_t{1} << 20;
+
+    RenderDevice& device;
+    const Shader& shader;
+    Layout layout;
+    std::size_t vertex_size;
+
+    GLuint vao = 0;
+    GLuint vertex_buffer = 0;
+    GLuint origin_buffer = 0;
+    GLuint command_buffer = 0;
+    QuadIndexBuffer quad_indices;
+    range_allocator allocator;
+};
+
+#endif  // !MESH_ARENA_H_
@@ -0,0 +1,46 @@
+#ifndef QUAD_INDEX_BUFFER_H_
+#define QUAD_INDEX_BUFFER_H_
+
+#include <glad/glad.h>
+
+#include <bit>
+#include <cstddef>
+
+#include "mesh.h"
+#include "render_device.h"
+
+// The index buffer shared by all the meshes made of quads, see quadIndices.
+// It only grows, so that it can be bound once to every vertex array
+class QuadIndexBuffer {
+   public:
+    explicit QuadIndexBuffer(RenderDevice& device)
+        : device(device), ibo(device.createBuffer()) {}
+    QuadIndexBuffer(const QuadIndexBuffer&) = delete;
+    QuadIndexBuffer& operator=(const QuadIndexBuffer&) = delete;
+    ~QuadIndexBuffer() {
+        if (ibo) device.deleteBuffer(ibo);
+    }
+
+    // Binds the buffer to the current vertex array, with enough indices for
+    // quad_count quads
+    void bind(std::size_t quad_count) {
+        device.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+        if (quad_count <= capacity) return;
+
+        capacity = std::bit_ceil(quad_count);
+        const auto indices = quadIndices(capacity);
+        device.bufferData(GL_ELEMENT_ARRAY_BUFFER,
+                          indices.size() * sizeof(quad_index), indices.data(),
+                          GL_STATIC_DRAW);
+    }
+
+    static constexpr GLenum index_type = GL_UNSIGNED_INT;
+    static_assert(sizeof(quad_index) == sizeof(GLuint));
+
+   private:
+    RenderDevice& device;
+    GLuint ibo = 0;
+    std::size_t capacity = 0;
+};
+
+#endif  // !QUAD_INDEX_BUFFER_H_
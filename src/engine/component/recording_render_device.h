@@ -0,0 +1,183 @@
+#ifndef RECORDING_RENDER_DEVICE_H_
+#define RECORDING_RENDER_DEVICE_H_
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <string>
+
+#include "render_device.h"
+#include "render_stats.h"
+
+// Counts the calls, then forwards them to the device if there is one.
+//
+// Without a device, it runs without a GPU, for tests and benchmarks: every
+// object gets a new handle, programs have no attribute nor uniform
+class RecordingRenderDevice final : public RenderDevice {
+   public:
+    explicit RecordingRenderDevice(RenderDevice* device = nullptr)
+        : device(device) {}
+
+    [[nodiscard]] const render_stats& stats() const { return recorded; }
+    void resetStats() { recorded = {}; }
+
+    GLuint createBuffer() override {
+        return create(device ? device->createBuffer() : 0);
+    }
+    void deleteBuffer(GLuint buffer) override {
+        recorded.objects_deleted++;
+        if (device) device->deleteBuffer(buffer);
+    }
+    void bindBuffer(GLenum target, GLuint buffer) override {
+        recorded.state_changes++;
+        if (device) device->bindBuffer(target, buffer);
+    }
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer) override {
+        recorded.state_changes++;
+        if (device) device->bindBufferBase(target, index, buffer);
+    }
+    void bufferData(GLenum target, std::size_t bytes, const void* data,
+                    GLenum usage) override {
+        if (data != nullptr) upload(target, bytes);
+        if (device) device->bufferData(target, bytes, data, usage);
+    }
+    void bufferSubData(GLenum target, std::size_t offset, std::size_t bytes,
+                       const void* data) override {
+        upload(target, bytes);
+        if (device) device->bufferSubData(target, offset, bytes, data);
+    }
+    void copyBufferSubData(GLenum read_target, GLenum write_target,
+                           std::size_t read_offset, std::size_t write_offset,
+                           std::size_t bytes) override {
+        if (device)
+            device->copyBufferSubData(read_target, write_target, read_offset,
+                                      write_offset, bytes);
+    }
+
+    GLuint createVertexArray() override {
+        return create(device ? device->createVertexArray() : 0);
+    }
+    void deleteVertexArray(GLuint vertex_array) override {
+        recorded.objects_deleted++;
+        if (device) device->deleteVertexArray(vertex_array);
+    }
+    void bindVertexArray(GLuint vertex_array) override {
+        recorded.state_changes++;
+        if (device) device->bindVertexArray(vertex_array);
+    }
+    void vertexAttribPointer(GLuint index, GLint size, GLenum type,
+                             bool integer, std::size_t stride,
+                             std::size_t offset) override {
+        recorded.state_changes++;
+        if (device)
+            device->vertexAttribPointer(index, size, type, integer, stride,
+                                        offset);
+    }
+    void enableVertexAttribArray(GLuint index) override {
+        recorded.state_changes++;
+        if (device) device->enableVertexAttribArray(index);
+    }
+    void vertexAttribDivisor(GLuint index, GLuint divisor) override {
+        recorded.state_changes++;
+        if (device) device->vertexAttribDivisor(index, divisor);
+    }
+
+    GLuint createProgram(const std::string& vertex_source,
+                         const std::string& fragment_source) override {
+        if (!device) return create(0);
+        return create(device->createProgram(vertex_source, fragment_source));
+    }
+    void deleteProgram(GLuint program) override {
+        recorded.objects_deleted++;
+        if (device) device->deleteProgram(program);
+    }
+    void useProgram(GLuint program) override {
+        recorded.state_changes++;
+        if (device) device->useProgram(program);
+    }
+    locations getAttribLocations(GLuint program) override {
+        return device ? device->getAttribLocations(program) : locations{};
+    }
+    locations getUniformLocations(GLuint program) override {
+        return device ? device->getUniformLocations(program) : locations{};
+    }
+    void uniform1i(GLint location, GLint value) override {
+        recorded.uniform_writes++;
+        if (device) device->uniform1i(location, value);
+    }
+
+    GLuint createTexture() override {
+        return create(device ? device->createTexture() : 0);
+    }
+    void deleteTexture(GLuint texture) override {
+        recorded.objects_deleted++;
+        if (device) device->deleteTexture(texture);
+    }
+    void bindTexture(GLenum target, GLuint texture) override {
+        recorded.state_changes++;
+        if (device) device->bindTexture(target, texture);
+    }
+    void texParameteri(GLenum target, GLenum name, GLint value) override {
+        recorded.state_changes++;
+        if (device) device->texParameteri(target, name, value);
+    }
+    void pixelStorei(GLenum name, GLint value) override {
+        recorded.state_changes++;
+        if (device) device->pixelStorei(name, value);
+    }
+    void texImage3D(GLenum target, GLint level, GLint internal_format,
+                    GLsizei width, GLsizei height, GLsizei depth, GLenum format,
+                    GLenum type, const void* data, std::size_t bytes) override {
+        if (data != nullptr) recorded.bytes_uploaded += bytes;
+        if (device)
+            device->texImage3D(target, level, internal_format, width, height,
+                               depth, format, type, data, bytes);
+    }
+    void texSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z,
+                       GLsizei width, GLsizei height, GLsizei depth,
+                       GLenum format, GLenum type, const void* data,
+                       std::size_t bytes) override {
+        recorded.bytes_uploaded += bytes;
+        if (device)
+            device->texSubImage3D(target, level, x, y, z, width, height, depth,
+                                  format, type, data, bytes);
+    }
+
+    void enable(GLenum capability) override {
+        recorded.state_changes++;
+        if (device) device->enable(capability);
+    }
+    void clearColor(float r, float g, float b, float a) override {
+        recorded.state_changes++;
+        if (device) device->clearColor(r, g, b, a);
+    }
+    void clear(GLbitfield mask) override {
+        if (device) device->clear(mask);
+    }
+    void multiDrawElementsIndirect(GLenum mode, GLenum type,
+                                   std::size_t indirect_offset,
+                                   GLsizei draw_count) override {
+        recorded.draw_calls++;
+        recorded.draws += static_cast<std::size_t>(draw_count);
+        if (device)
+            device->multiDrawElementsIndirect(mode, type, indirect_offset,
+                                              draw_count);
+    }
+
+   private:
+    // Handles are made up without a device
+    GLuint create(GLuint handle) {
+        recorded.objects_created++;
+        return device ? handle : ++last_handle;
+    }
+    void upload(GLenum target, std::size_t bytes) {
+        recorded.bytes_uploaded += bytes;
+        if (target == GL_UNIFORM_BUFFER) recorded.uniform_writes++;
+    }
+
+    RenderDevice* device;
+    render_stats recorded;
+    GLuint last_handle = 0;
+};
+
+#endif  // !RECORDING_RENDER_DEVICE_H_
@@ -0,0 +1,87 @@
+#ifndef RENDER_DEVICE_H_
+#define RENDER_DEVICE_H_
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The calls the renderer makes to the GPU. GLRenderDevice forwards them to
+// OpenGL, RecordingRenderDevice counts them, on top of another device or
+// alone so that the frame path can run and be measured without a GPU.
+//
+// Handles, targets and enums are the ones of OpenGL
+class RenderDevice {
+   public:
+    RenderDevice() = default;
+    RenderDevice(const RenderDevice&) = delete;
+    RenderDevice& operator=(const RenderDevice&) = delete;
+    virtual ~RenderDevice() = default;
+
+    // Buffers
+    virtual GLuint createBuffer() = 0;
+    virtual void deleteBuffer(GLuint buffer) = 0;
+    virtual void bindBuffer(GLenum target, GLuint buffer) = 0;
+    virtual void bindBufferBase(GLenum target, GLuint index,
+                                GLuint buffer) = 0;
+    virtual void bufferData(GLenum target, std::size_t bytes, const void* data,
+                            GLenum usage) = 0;
+    virtual void bufferSubData(GLenum target, std::size_t offset,
+                               std::size_t bytes, const void* data) = 0;
+    virtual void copyBufferSubData(GLenum read_target, GLenum write_target,
+                                   std::size_t read_offset,
+                                   std::size_t write_offset,
+                                   std::size_t bytes) = 0;
+
+    // Vertex arrays
+    virtual GLuint createVertexArray() = 0;
+    virtual void deleteVertexArray(GLuint vertex_array) = 0;
+    virtual void bindVertexArray(GLuint vertex_array) = 0;
+    // integer attributes are not converted to float
+    virtual void vertexAttribPointer(GLuint index, GLint size, GLenum type,
+                                     bool integer, std::size_t stride,
+                                     std::size_t offset) = 0;
+    virtual void enableVertexAttribArray(GLuint index) = 0;
+    virtual void vertexAttribDivisor(GLuint index, GLuint divisor) = 0;
+
+    // Programs. createProgram throws a std::runtime_error with the log of the
+    // compiler if the sources do not compile or link
+    virtual GLuint createProgram(const std::string& vertex_source,
+                                 const std::string& fragment_source) = 0;
+    virtual void deleteProgram(GLuint program) = 0;
+    virtual void useProgram(GLuint program) = 0;
+    using locations = std::vector<std::pair<std::string, GLint>>;
+    virtual locations getAttribLocations(GLuint program) = 0;
+    virtual locations getUniformLocations(GLuint program) = 0;
+    // On the program in use
+    virtual void uniform1i(GLint location, GLint value) = 0;
+
+    // Textures
+    virtual GLuint createTexture() = 0;
+    virtual void deleteTexture(GLuint texture) = 0;
+    virtual void bindTexture(GLenum target, GLuint texture) = 0;
+    virtual void texParameteri(GLenum target, GLenum name, GLint value) = 0;
+    virtual void pixelStorei(GLenum name, GLint value) = 0;
+    // bytes is the size of the data read, for the statistics
+    virtual void texImage3D(GLenum target, GLint level, GLint internal_format,
+                            GLsizei width, GLsizei height, GLsizei depth,
+                            GLenum format, GLenum type, const void* data,
+                            std::size_t bytes) = 0;
+    virtual void texSubImage3D(GLenum target, GLint level, GLint x, GLint y,
+                               GLint z, GLsizei width, GLsizei height,
+                               GLsizei depth, GLenum format, GLenum type,
+                               const void* data, std::size_t bytes) = 0;
+
+    // Frame
+    virtual void enable(GLenum capability) = 0;
+    virtual void clearColor(float r, float g, float b, float a) = 0;
+    virtual void clear(GLbitfield mask) = 0;
+    // The commands are read from the bound GL_DRAW_INDIRECT_BUFFER
+    virtual void multiDrawElementsIndirect(GLenum mode, GLenum type,
+                                           std::size_t indirect_offset,
+                                           GLsizei draw_count) = 0;
+};
+
+#endif  // !RENDER_DEVICE_H_
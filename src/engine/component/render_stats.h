@@ -0,0 +1,40 @@
+#ifndef RENDER_STATS_H_
+#define RENDER_STATS_H_
+
+#include <cstddef>
+#include <ostream>
+
+#include "../data_structure/ring_buffer.h"
+
+// What has been submitted to a RecordingRenderDevice
+struct render_stats {
+    // glMultiDrawElementsIndirect calls, and the draws they contain
+    std::size_t draw_calls = 0;
+    std::size_t draws = 0;
+    // Bindings, program and vertex attribute changes, capabilities
+    std::size_t state_changes = 0;
+    // Buffer and texture data sent to the GPU
+    std::size_t bytes_uploaded = 0;
+    // Uniforms set on programs, and writes to uniform buffers
+    std::size_t uniform_writes = 0;
+    std::size_t objects_created = 0;
+    std::size_t objects_deleted = 0;
+};
+
+// The statistics of the last frames, oldest first
+using render_stats_history = ring_buffer<render_stats>;
+
+// One line per frame, oldest first, after a header naming the columns
+inline void writeCsv(std::ostream& out, const render_stats_history& history) {
+    out << "frame,draw_calls,draws,state_changes,bytes_uploaded,"
+           "uniform_writes,objects_created,objects_deleted\n";
+    for (std::size_t i = 0; i < history.size(); i++) {
+        const auto& frame = history[i];
+        out << i << ',' << frame.draw_calls << ',' << frame.draws << ','
+            << frame.state_changes << ',' << frame.bytes_uploaded << ','
+            << frame.uniform_writes << ',' << frame.objects_created << ','
+            << frame.objects_deleted << '\n';
+    }
+}
+
+#endif  // !RENDER_STATS_H_
@@ -1,2 +0,0 @@
-#include "renderer_context.h"
-GLuint RendererContext::current_vao = 0;
@@ -3,60 +3,78 @@
 
 #include <glad/glad.h>
 
+#include <functional>
 #include <iostream>
+#include <map>
 #include <string>
+#include <utility>
 
 #include "../data/shader_layout.h"
 #include "../utils/logging.h"
+#include "render_device.h"
 
 class Shader {
    private:
     class UseShaderWithRAII {
        public:
-        UseShaderWithRAII(GLuint shader_program, GLuint current_shader_): old_shader_in_use(current_shader_) {
-            if(shader_program) glUseProgram(shader_program);
+        UseShaderWithRAII(RenderDevice *device, GLuint shader_program,
+                          GLuint current_shader_)
+            : device(device), old_shader_in_use(current_shader_) {
+            if (shader_program) device->useProgram(shader_program);
         }
 
         ~UseShaderWithRAII() {
-            if (old_shader_in_use) glUseProgram(old_shader_in_use);
+            if (old_shader_in_use) device->useProgram(old_shader_in_use);
         }
 
        private:
+        RenderDevice *device;
         GLuint old_shader_in_use;
         Logger log = Logger::get({"Shader"});
     };
 
    public:
-    Shader(const std::string &vertex_shader_source,
+    Shader(RenderDevice &device, const std::string &vertex_shader_source,
            const std::string &fragment_shader_source);
     Shader(Shader &) = delete;
-    Shader(Shader &&other) noexcept {
-        vertex_shader = other.vertex_shader;
-        fragment_shader = other.fragment_shader;
-        shader_program = other.shader_program;
-
-        other.shader_program = other.fragment_shader = other.vertex_shader = 0;
+    Shader(Shader &&other) noexcept
+        : device(other.device),
+          shader_program(other.shader_program),
+          attrib_locations(std::move(other.attrib_locations)),
+          uniform_locations(std::move(other.uniform_locations)) {
+        other.shader_program = 0;
     }
     ~Shader();
 
+    // Resolved once when the program is linked, -1 if the shader does not use
+    // the name
     GLint getAttribLocation(const char *attrib) const {
-        return glGetAttribLocation(shader_program, attrib);
+        return findLocation(attrib_locations, attrib);
     }
     GLint getUniformLocation(const char *attrib) const {
-        return glGetUniformLocation(shader_program, attrib);
+        return findLocation(uniform_locations, attrib);
     }
 
     [[nodiscard]] UseShaderWithRAII use() const {
         if (shader_program == current_shader)
-            return {0, 0}; // Do nothing shader swap
+            return {device, 0, 0}; // Do nothing shader swap
         current_shader = shader_program;
-        return {shader_program, current_shader};
+        return {device, shader_program, current_shader};
     }
 
     void useLayout(const Layout &) const;
 
    private:
-    GLuint vertex_shader, fragment_shader, shader_program;
+    using locations = std::map<std::string, GLint, std::less<>>;
+    static GLint findLocation(const locations &locations, const char *name) {
+        auto it = locations.find(name);
+        return it == locations.end() ? -1 : it->second;
+    }
+
+    RenderDevice *device;
+    GLuint shader_program;
+    locations attrib_locations;
+    locations uniform_locations;
     Logger log = Logger::get({"Shader"});
 
     static GLuint current_shader;
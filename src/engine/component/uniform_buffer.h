@@ -0,0 +1,41 @@
+#ifndef UNIFORM_BUFFER_H_
+#define UNIFORM_BUFFER_H_
+
+#include <glad/glad.h>
+
+#include <type_traits>
+
+#include "render_device.h"
+
+// A uniform block of the shaders, bound once to its binding point. Block must
+// follow the std140 layout of the block in the shaders
+template <typename Block>
+class UniformBuffer {
+    static_assert(std::is_trivially_copyable_v<Block>);
+    static_assert(sizeof(Block) % 16 == 0, "std140 blocks are vec4 aligned");
+
+   public:
+    UniformBuffer(RenderDevice& device, GLuint binding)
+        : device(device), ubo(device.createBuffer()) {
+        device.bindBuffer(GL_UNIFORM_BUFFER, ubo);
+        device.bufferData(GL_UNIFORM_BUFFER, sizeof(Block), nullptr,
+                          GL_DYNAMIC_DRAW);
+        device.bindBufferBase(GL_UNIFORM_BUFFER, binding, ubo);
+    }
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+    ~UniformBuffer() {
+        if (ubo) device.deleteBuffer(ubo);
+    }
+
+    void update(const Block& block) const {
+        device.bindBuffer(GL_UNIFORM_BUFFER, ubo);
+        device.bufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &block);
+    }
+
+   private:
+    RenderDevice& device;
+    GLuint ubo = 0;
+};
+
+#endif  // !UNIFORM_BUFFER_H_
@@ -7,6 +7,7 @@
 
 #include "../component/shader.h"
 #include "../component/texture_atlas.h"
+#include "baked_atlas.h"
 
 namespace fs = std::filesystem;
 
@@ -42,17 +43,27 @@ constexpr auto get_asset = &get_asset_helper<kind>::get_asset;
 
 template <>
 struct get_asset_helper<AssetKind::TextureAtlas> {
-    static TextureAtlas get_asset(const std::string& asset_name,
+    // The atlas is baked into baked_directory
+    static TextureAtlas get_asset(RenderDevice& device,
+                                  const std::string& asset_name,
                                   std::size_t horizontal_tiles,
-                                  std::size_t vertical_tiles) {
-        return {get_asset_path(AssetKind::TextureAtlas, asset_name),
-                horizontal_tiles, vertical_tiles};
+                                  std::size_t vertical_tiles,
+                                  const fs::path& baked_directory) {
+        const fs::path image =
+            get_asset_path(AssetKind::TextureAtlas, asset_name);
+        const fs::path baked =
+            baked_directory / asset_path.at(AssetKind::TextureAtlas) /
+            (asset_name + ".atlas");
+        BakedAtlasFile::bake_if_outdated(image, baked, horizontal_tiles,
+                                         vertical_tiles);
+        return {device, BakedAtlasFile{baked}};
     }
 };
 
 template <>
 struct get_asset_helper<AssetKind::Shader> {
-    static Shader get_asset(const std::string& asset_name) {
+    static Shader get_asset(RenderDevice& device,
+                            const std::string& asset_name) {
         fs::path base_asset_path =
             get_asset_path(AssetKind::Shader, asset_name);
 
@@ -62,7 +73,7 @@ struct get_asset_helper<AssetKind::Shader> {
         fs::path fragment_shader_path = base_asset_path;
         fragment_shader_path += ".frag";
 
-        return {asset_details::load_file(vertex_shader_path),
+        return {device, asset_details::load_file(vertex_shader_path),
                 asset_details::load_file(fragment_shader_path)};
     }
 };
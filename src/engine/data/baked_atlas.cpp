@@ -0,0 +1,246 @@
+#include "baked_atlas.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include "../utils/logging.h"
+#include "../utils/profiler.h"
+
+namespace {
+const std::size_t texel_size = 4;
+const std::size_t header_size = 7 * sizeof(std::uint32_t);
+
+std::size_t level_bytes(std::uint32_t width, std::uint32_t height,
+                        std::uint32_t layers, std::size_t level) {
+    return std::size_t{layers} * mip_size(width, level) *
+           mip_size(height, level) * texel_size;
+}
+
+// The texels are sRGB encoded: the colors are averaged once decoded to linear,
+// or the mipmaps would get darker. Alpha is linear
+float srgb_to_linear(std::uint8_t value) {
+    const float c = static_cast<float>(value) / 255.0F;
+    return c <= 0.04045F ? c / 12.92F : std::pow((c + 0.055F) / 1.055F, 2.4F);
+}
+
+std::uint8_t linear_to_srgb(float c) {
+    c = std::clamp(c, 0.0F, 1.0F);
+    const float value = c <= 0.0031308F
+                            ? c * 12.92F
+                            : 1.055F * std::pow(c, 1.0F / 2.4F) - 0.055F;
+    return static_cast<std::uint8_t>(std::lround(value * 255.0F));
+}
+
+// The level below source, of width x height texels per layer. Texels out of
+// odd sized levels are clamped
+std::vector<std::uint8_t> downsample(const std::vector<std::uint8_t>& source,
+                                     std::uint32_t width, std::uint32_t height,
+                                     std::uint32_t layers) {
+    static const auto linear = [] {
+        std::array<float, 256> table{};
+        for (std::size_t i = 0; i < table.size(); i++)
+            table[i] = srgb_to_linear(static_cast<std::uint8_t>(i));
+        return table;
+    }();
+
+    const std::uint32_t mip_width = mip_size(width, 1);
+    const std::uint32_t mip_height = mip_size(height, 1);
+    std::vector<std::uint8_t> mip(std::size_t{layers} * mip_width *
+                                  mip_height * texel_size);
+
+    auto texel = [&](std::size_t layer, std::size_t x, std::size_t y) {
+        x = std::min<std::size_t>(x, width - 1);
+        y = std::min<std::size_t>(y, height - 1);
+        return &source[((layer * height + y) * width + x) * texel_size];
+    };
+    std::uint8_t* out = mip.data();
+    for (std::size_t layer = 0; layer < layers; layer++)
+        for (std::size_t y = 0; y < mip_height; y++)
+            for (std::size_t x = 0; x < mip_width; x++) {
+                const std::array quad{texel(layer, 2 * x, 2 * y),
+                                      texel(layer, 2 * x + 1, 2 * y),
+                                      texel(layer, 2 * x, 2 * y + 1),
+                                      texel(layer, 2 * x + 1, 2 * y + 1)};
+                for (std::size_t c = 0; c < 3; c++) {
+                    float sum = 0;
+                    for (const auto* t : quad) sum += linear[t[c]];
+                    *out++ = linear_to_srgb(sum / 4);
+                }
+                // Rounded to the nearest
+                unsigned alpha = 0;
+                for (const auto* t : quad) alpha += t[3];
+                *out++ = static_cast<std::uint8_t>((alpha + 2) / 4);
+            }
+    return mip;
+}
+
+template <typename T>
+void write_value(std::ofstream& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));  // NOLINT
+}
+}  // namespace
+
+baked_atlas bake_atlas(const std::uint8_t* rgba, std::size_t width,
+                       std::size_t height, std::size_t horizontal_tiles,
+                       std::size_t vertical_tiles) {
+    if (horizontal_tiles == 0 || vertical_tiles == 0 ||
+        width % horizontal_tiles != 0 || height % vertical_tiles != 0 ||
+        width < horizontal_tiles || height < vertical_tiles)
+        throw std::runtime_error("the atlas does not split in whole tiles");
+
+    baked_atlas atlas;
+    atlas.width = static_cast<std::uint32_t>(width / horizontal_tiles);
+    atlas.height = static_cast<std::uint32_t>(height / vertical_tiles);
+    atlas.horizontal_tiles = static_cast<std::uint32_t>(horizontal_tiles);
+    atlas.vertical_tiles = static_cast<std::uint32_t>(vertical_tiles);
+
+    auto& base = atlas.levels.emplace_back(
+        level_bytes(atlas.width, atlas.height, atlas.layers(), 0));
+    const std::size_t row_bytes = atlas.width * texel_size;
+    for (std::size_t i = 0; i < horizontal_tiles; i++) {
+        for (std::size_t j = 0; j < vertical_tiles; j++) {
+            const std::size_t layer = horizontal_tiles * j + i;
+            for (std::size_t y = 0; y < atlas.height; y++) {
+                const std::size_t source =
+                    ((j * atlas.height + y) * width + i * atlas.width) *
+                    texel_size;
+                const std::size_t dest = (layer * atlas.height + y) * row_bytes;
+                std::memcpy(&base[dest], rgba + source, row_bytes);  // NOLINT
+            }
+        }
+    }
+
+    for (std::size_t level = 1;
+         mip_size(atlas.width, level - 1) > 1 ||
+         mip_size(atlas.height, level - 1) > 1;
+         level++)
+        atlas.levels.push_back(downsample(
+            atlas.levels.back(), mip_size(atlas.width, level - 1),
+            mip_size(atlas.height, level - 1), atlas.layers()));
+    return atlas;
+}
+
+baked_atlas bake_atlas(const fs::path& image, std::size_t horizontal_tiles,
+                       std::size_t vertical_tiles) {
+    PROFILE_SCOPED();
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    // Converted to RGBA whatever the channels of the file
+    stbi_uc* rgba = stbi_load(image.string().c_str(), &width, &height,
+                              &channels, static_cast<int>(texel_size));
+    if (rgba == nullptr)
+        throw std::runtime_error("could not load " + image.string() + ": " +
+                                 stbi_failure_reason());
+
+    try {
+        auto atlas = bake_atlas(rgba, static_cast<std::size_t>(width),
+                                static_cast<std::size_t>(height),
+                                horizontal_tiles, vertical_tiles);
+        stbi_image_free(rgba);
+        return atlas;
+    } catch (...) {
+        stbi_image_free(rgba);
+        throw;
+    }
+}
+
+void BakedAtlasFile::save(const fs::path& path, const baked_atlas& atlas) {
+    fs::create_directories(path.parent_path());
+
+    // Written aside then renamed, a crash never leaves a truncated atlas
+    auto temporary_path = path;
+    temporary_path += ".tmp";
+    {
+        std::ofstream f(temporary_path, std::ios::binary);
+        if (!f.is_open())
+            throw std::runtime_error("could not open " +
+                                     temporary_path.string());
+
+        write_value(f, magic);
+        write_value(f, version);
+        write_value(f, atlas.width);
+        write_value(f, atlas.height);
+        write_value(f, atlas.horizontal_tiles);
+        write_value(f, atlas.vertical_tiles);
+        write_value(f, static_cast<std::uint32_t>(atlas.levels.size()));
+        for (const auto& level : atlas.levels)
+            f.write(reinterpret_cast<const char*>(level.data()),  // NOLINT
+                    static_cast<std::streamsize>(level.size()));
+        if (!f)
+            throw std::runtime_error("could not write " +
+                                     temporary_path.string());
+    }
+    fs::rename(temporary_path, path);
+}
+
+void BakedAtlasFile::bake_if_outdated(const fs::path& image,
+                                      const fs::path& path,
+                                      std::size_t horizontal_tiles,
+                                      std::size_t vertical_tiles) {
+    auto log = Logger::get({"BakedAtlasFile"});
+
+    std::error_code error;
+    const auto baked_time = fs::last_write_time(path, error);
+    if (!error && baked_time >= fs::last_write_time(image)) {
+        try {
+            const BakedAtlasFile baked{path};
+            if (baked.horizontal_tiles() == horizontal_tiles &&
+                baked.vertical_tiles() == vertical_tiles)
+                return;
+        } catch (const std::runtime_error& e) {
+            log << LogLevel::Warning << e.what();
+        }
+    }
+
+    log << LogLevel::Info << "Baking " << image.string() << " into "
+        << path.string();
+    save(path, bake_atlas(image, horizontal_tiles, vertical_tiles));
+}
+
+BakedAtlasFile::BakedAtlasFile(const fs::path& path) : file(path) {
+    auto invalid = [&](const char* why) {
+        return std::runtime_error(path.string() + ": " + why);
+    };
+    if (file.size() < header_size) throw invalid("truncated");
+
+    std::uint32_t header[7];  // NOLINT
+    std::memcpy(header, file.data(), header_size);
+    const auto [file_magic, file_version, width, height, horizontal,
+                vertical, levels] = header;
+    if (file_magic != magic || file_version != version)
+        throw invalid("not a baked atlas of this version");
+    // At most one level per bit of the size
+    if (width == 0 || height == 0 || levels == 0 || levels > 32)
+        throw invalid("corrupted header");
+    tile_width = width;
+    tile_height = height;
+    columns = horizontal;
+    rows = vertical;
+
+    std::size_t offset = header_size;
+    for (std::size_t level = 0; level < levels; level++) {
+        offsets.push_back(offset);
+        offset += level_size(level);
+    }
+    if (offset > file.size()) throw invalid("truncated");
+}
+
+const std::uint8_t* BakedAtlasFile::level(std::size_t i) const {
+    return reinterpret_cast<const std::uint8_t*>(file.data()) +  // NOLINT
+           offsets[i];
+}
+
+std::size_t BakedAtlasFile::level_size(std::size_t i) const {
+    return level_bytes(tile_width, tile_height, layers(), i);
+}
@@ -0,0 +1,88 @@
+#ifndef BAKED_ATLAS_H_
+#define BAKED_ATLAS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace fs = std::filesystem;
+
+// A texture atlas cut in tiles, ready to be uploaded as a 2D array texture:
+// one RGBA8 layer per tile, with all its mipmaps
+struct baked_atlas {
+    // Size of a tile
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::uint32_t horizontal_tiles = 0;
+    std::uint32_t vertical_tiles = 0;
+    // Level i holds the layers one after the other, each of them
+    // mip_size(width, i) x mip_size(height, i) texels
+    std::vector<std::vector<std::uint8_t>> levels;
+
+    [[nodiscard]] std::uint32_t layers() const {
+        return horizontal_tiles * vertical_tiles;
+    }
+};
+
+// Size of a texture at mipmap level
+constexpr std::uint32_t mip_size(std::uint32_t size, std::size_t level) {
+    const std::uint32_t mip = size >> level;
+    return mip == 0 ? 1 : mip;
+}
+
+// Cuts an RGBA8 image of width x height texels. The tile at column i, row j
+// goes to layer horizontal_tiles * j + i. The mipmaps go down to 1x1, each
+// texel is the average of 2x2 texels of the level above, in linear space for
+// the sRGB colors. Throws a std::runtime_error if the image does not split in
+// whole tiles
+baked_atlas bake_atlas(const std::uint8_t* rgba, std::size_t width,
+                       std::size_t height, std::size_t horizontal_tiles,
+                       std::size_t vertical_tiles);
+// Decodes the image, then bakes it
+baked_atlas bake_atlas(const fs::path& image, std::size_t horizontal_tiles,
+                       std::size_t vertical_tiles);
+
+// A baked atlas file:
+//   - magic, version, width, height, horizontal_tiles, vertical_tiles and the
+//     number of levels, as 7 uint32
+//   - the levels, one after the other, see baked_atlas
+class BakedAtlasFile {
+   public:
+    static constexpr std::uint32_t magic = 0x5441434d;  // "MCAT"
+    static constexpr std::uint32_t version = 2;
+
+    static void save(const fs::path& path, const baked_atlas& atlas);
+    // Bakes image into path, unless path is already a bake of the current
+    // image with the same tiles
+    static void bake_if_outdated(const fs::path& image, const fs::path& path,
+                                 std::size_t horizontal_tiles,
+                                 std::size_t vertical_tiles);
+
+    // Maps the file. Throws a std::runtime_error if it can not be read or is
+    // not a baked atlas of this version
+    explicit BakedAtlasFile(const fs::path& path);
+
+    [[nodiscard]] std::uint32_t width() const { return tile_width; }
+    [[nodiscard]] std::uint32_t height() const { return tile_height; }
+    [[nodiscard]] std::uint32_t horizontal_tiles() const { return columns; }
+    [[nodiscard]] std::uint32_t vertical_tiles() const { return rows; }
+    [[nodiscard]] std::uint32_t layers() const { return columns * rows; }
+    [[nodiscard]] std::size_t level_count() const { return offsets.size(); }
+    // Points into the mapping
+    [[nodiscard]] const std::uint8_t* level(std::size_t i) const;
+    [[nodiscard]] std::size_t level_size(std::size_t i) const;
+
+   private:
+    MappedFile file;
+    std::uint32_t tile_width = 0;
+    std::uint32_t tile_height = 0;
+    std::uint32_t columns = 0;
+    std::uint32_t rows = 0;
+    // Of the levels in the file
+    std::vector<std::size_t> offsets;
+};
+
+#endif  // !BAKED_ATLAS_H_
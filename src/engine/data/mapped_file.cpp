@@ -0,0 +1,53 @@
+#include "mapped_file.h"
+
+#include <fstream>
+#include <stdexcept>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const fs::path& path) {
+#ifdef __unix__
+    int fd = ::open(path.c_str(), O_RDONLY);  // NOLINT
+    if (fd < 0) throw std::runtime_error("could not open " + path.string());
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("could not stat " + path.string());
+    }
+
+    length = static_cast<std::size_t>(st.st_size);
+    if (length > 0) {
+        void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {  // NOLINT
+            ::close(fd);
+            throw std::runtime_error("could not mmap " + path.string());
+        }
+        begin = static_cast<const std::byte*>(mapping);
+    }
+    ::close(fd);  // the mapping stays valid
+#else
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f.is_open())
+        throw std::runtime_error("could not open " + path.string());
+
+    length = static_cast<std::size_t>(f.tellg());
+    fallback = std::make_unique<std::byte[]>(length);  // NOLINT
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(fallback.get()),  // NOLINT
+           static_cast<std::streamsize>(length));
+    begin = fallback.get();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef __unix__
+    if (begin != nullptr)
+        ::munmap(const_cast<std::byte*>(begin), length);  // NOLINT
+#endif
+}
@@ -0,0 +1,36 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+
+namespace fs = std::filesystem;
+
+// A read only view of a whole file, through mmap when there is one. Throws a
+// std::runtime_error if the file can not be opened
+class MappedFile {
+   public:
+    // Whether the view sees the writes to the file made after it was created,
+    // within its size. Otherwise it is a copy
+#ifdef __unix__
+    static constexpr bool shared = true;
+#else
+    static constexpr bool shared = false;
+#endif
+
+    explicit MappedFile(const fs::path& path);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    [[nodiscard]] const std::byte* data() const { return begin; }
+    [[nodiscard]] std::size_t size() const { return length; }
+
+   private:
+    const std::byte* begin = nullptr;
+    std::size_t length = 0;
+    std::unique_ptr<std::byte[]> fallback;  // NOLINT: when there is no mmap
+};
+
+#endif  // !MAPPED_FILE_H_
@@ -0,0 +1,142 @@
+#include "program_binary_cache.h"
+
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace {
+// FNV-1a, 64 bits
+constexpr std::uint64_t fnv_offset = 0xcbf29ce484222325;
+constexpr std::uint64_t fnv_prime = 0x100000001b3;
+
+std::uint64_t hash_bytes(std::uint64_t hash, std::string_view bytes) {
+    for (const char c : bytes) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= fnv_prime;
+    }
+    return hash;
+}
+
+struct header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t format;
+    std::uint64_t compile_us;
+    std::uint64_t size;
+};
+
+// Values are written in native endianness, like the region files
+template <typename T>
+void write_value(std::ofstream& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));  // NOLINT
+}
+
+template <typename T>
+bool read_value(std::ifstream& in, T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return static_cast<bool>(
+        in.read(reinterpret_cast<char*>(&value), sizeof(T)));  // NOLINT
+}
+}  // namespace
+
+ProgramBinaryCache::ProgramBinaryCache(fs::path directory)
+    : directory(std::move(directory)) {}
+
+std::uint64_t ProgramBinaryCache::key(const std::string& driver,
+                                      const std::string& vertex_source,
+                                      const std::string& fragment_source) {
+    // The separators keep "ab" + "c" and "a" + "bc" apart
+    std::uint64_t hash = fnv_offset;
+    hash = hash_bytes(hash, driver);
+    hash = hash_bytes(hash, std::string_view{"\0", 1});
+    hash = hash_bytes(hash, vertex_source);
+    hash = hash_bytes(hash, std::string_view{"\0", 1});
+    return hash_bytes(hash, fragment_source);
+}
+
+fs::path ProgramBinaryCache::entry_path(std::uint64_t key) const {
+    std::array<char, 17> name{};
+    std::snprintf(name.data(), name.size(), "%016llx",
+                  static_cast<unsigned long long>(key));
+    return directory / (std::string{name.data()} + ".bin");
+}
+
+std::optional<program_binary> ProgramBinaryCache::load(
+    std::uint64_t key) const {
+    const auto path = entry_path(key);
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open()) return {};
+
+    header h{};
+    if (!read_value(f, h.magic) || !read_value(f, h.version) ||
+        !read_value(f, h.format) || !read_value(f, h.compile_us) ||
+        !read_value(f, h.size))
+        return {};
+    if (h.magic != magic || h.version != version) {
+        log << LogLevel::Warning << "Ignoring " << path.string()
+            << ": not a program binary of this version";
+        return {};
+    }
+    std::error_code error;
+    if (h.size > fs::file_size(path, error) || error) {
+        log << LogLevel::Warning << "Ignoring " << path.string()
+            << ": truncated";
+        return {};
+    }
+
+    program_binary binary{h.format, std::vector<std::byte>(h.size),
+                          std::chrono::microseconds{h.compile_us}};
+    if (!f.read(reinterpret_cast<char*>(binary.data.data()),  // NOLINT
+                static_cast<std::streamsize>(h.size))) {
+        log << LogLevel::Warning << "Ignoring " << path.string()
+            << ": truncated";
+        return {};
+    }
+    return binary;
+}
+
+void ProgramBinaryCache::save(std::uint64_t key,
+                              const program_binary& binary) const {
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (error) {
+        log << LogLevel::Warning << "Could not create " << directory.string()
+            << ": " << error.message();
+        return;
+    }
+
+    // Written aside then renamed, a crash never leaves a truncated entry
+    const auto path = entry_path(key);
+    auto temporary_path = path;
+    temporary_path += ".tmp";
+    {
+        std::ofstream f(temporary_path, std::ios::binary);
+        if (!f.is_open()) {
+            log << LogLevel::Warning << "Could not open "
+                << temporary_path.string();
+            return;
+        }
+        write_value(f, magic);
+        write_value(f, version);
+        write_value(f, binary.format);
+        write_value(f,
+                    static_cast<std::uint64_t>(binary.compile_time.count()));
+        write_value(f, static_cast<std::uint64_t>(binary.data.size()));
+        f.write(reinterpret_cast<const char*>(binary.data.data()),  // NOLINT
+                static_cast<std::streamsize>(binary.data.size()));
+        if (!f) {
+            log << LogLevel::Warning << "Could not write "
+                << temporary_path.string();
+            return;
+        }
+    }
+    fs::rename(temporary_path, path, error);
+    if (error)
+        log << LogLevel::Warning << "Could not write " << path.string() << ": "
+            << error.message();
+}
@@ -0,0 +1,59 @@
+#ifndef PROGRAM_BINARY_CACHE_H_
+#define PROGRAM_BINARY_CACHE_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../utils/logging.h"
+
+namespace fs = std::filesystem;
+
+// A linked program as given by glGetProgramBinary
+struct program_binary {
+    std::uint32_t format = 0;
+    std::vector<std::byte> data;
+    // Time it took to compile and link it from the sources
+    std::chrono::microseconds compile_time{};
+};
+
+// On disk cache of linked programs, so that the shaders are not compiled at
+// every launch. One file per program:
+//   - magic and version, as 2 uint32
+//   - format as uint32, compile time in microseconds and size as 2 uint64
+//   - the binary
+//
+// Programs are keyed by a hash of their sources and of the driver: a binary
+// is only valid for the driver that produced it. A driver may still refuse a
+// binary, the program is then compiled again and the entry replaced.
+class ProgramBinaryCache {
+   public:
+    static constexpr std::uint32_t magic = 0x4750434d;  // "MCPG"
+    static constexpr std::uint32_t version = 1;
+
+    explicit ProgramBinaryCache(fs::path directory);
+
+    // driver identifies the GL implementation, for instance its vendor,
+    // renderer and version strings
+    static std::uint64_t key(const std::string& driver,
+                             const std::string& vertex_source,
+                             const std::string& fragment_source);
+
+    // Nothing if the program has never been saved, or if its file is not
+    // readable
+    [[nodiscard]] std::optional<program_binary> load(std::uint64_t key) const;
+    // Failures are logged, the cache is only an optimization
+    void save(std::uint64_t key, const program_binary& binary) const;
+
+    [[nodiscard]] fs::path entry_path(std::uint64_t key) const;
+
+   private:
+    fs::path directory;
+    Logger log{Logger::get({"ProgramBinaryCache"})};
+};
+
+#endif  // !PROGRAM_BINARY_CACHE_H_
@@ -0,0 +1,278 @@
+#include "region_storage.h"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "../data_structure/scratch_arena.h"
+#include "../utils/profiler.h"
+
+namespace {
+const std::size_t table_offset = 3 * sizeof(std::uint32_t);
+const std::size_t table_entry_size = 2 * sizeof(std::uint32_t);
+const std::size_t table_size = RegionStorage::region_size *
+                               RegionStorage::region_size * table_entry_size;
+const std::size_t header_sectors =
+    (table_offset + table_size + RegionStorage::sector_size - 1) /
+    RegionStorage::sector_size;
+
+// Values are written in native endianness
+template <typename T>
+void write_value(std::vector<std::byte>& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    const auto* bytes = reinterpret_cast<const std::byte*>(&value);  // NOLINT
+    out.insert(out.end(), bytes, bytes + sizeof(T));                 // NOLINT
+}
+
+class Reader {
+   public:
+    Reader(const std::byte* data, std::size_t size) : data(data), size(size) {}
+
+    template <typename T>
+    std::optional<T> read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (size - position < sizeof(T)) return {};
+
+        T value;
+        std::memcpy(&value, data + position, sizeof(T));  // NOLINT
+        position += sizeof(T);
+        return value;
+    }
+
+    [[nodiscard]] bool at_end() const { return position == size; }
+
+   private:
+    const std::byte* data;
+    std::size_t size;
+    std::size_t position = 0;
+};
+
+// The serialized chunk of save, see scratch_arena
+struct save_scratch {
+    std::vector<std::byte> payload;
+};
+
+void serialize(const Chunk& chunk, std::vector<std::byte>& out) {
+    out.clear();
+    write_value(out, static_cast<std::int32_t>(chunk.getId().x));
+    write_value(out, static_cast<std::int32_t>(chunk.getId().z));
+
+    for (std::size_t i = 0; i < chunkSectionCount; i++) {
+        const auto& section = chunk.getSection(i);
+        write_value(out, static_cast<std::uint8_t>(section.bits_per_index()));
+        write_value(out,
+                    static_cast<std::uint16_t>(section.raw_palette().size()));
+        for (const auto& block : section.raw_palette())
+            write_value(out, static_cast<std::uint8_t>(block.type));
+
+        write_value(out, static_cast<std::uint32_t>(section.raw_words().size()));
+        for (auto word : section.raw_words()) write_value(out, word);
+    }
+}
+
+std::optional<Chunk> deserialize(chunk_identifier id, const std::byte* data,
+                                 std::size_t size) {
+    Reader reader{data, size};
+
+    auto x = reader.read<std::int32_t>();
+    auto z = reader.read<std::int32_t>();
+    if (!x || !z || *x != id.x || *z != id.z) return {};
+
+    std::array<block_storage, chunkSectionCount> sections;
+    for (auto& section : sections) {
+        auto bits = reader.read<std::uint8_t>();
+        auto palette_size = reader.read<std::uint16_t>();
+        if (!bits || !palette_size) return {};
+
+        std::vector<BlockData> palette;
+        palette.reserve(*palette_size);
+        for (std::size_t i = 0; i < *palette_size; i++) {
+            auto type = reader.read<std::uint8_t>();
+            // Blocks the engine does not know would be drawn as garbage
+            if (!type || *type > static_cast<std::uint8_t>(BlockType::Grass))
+                return {};
+            palette.push_back({static_cast<BlockType>(*type)});
+        }
+
+        auto word_count = reader.read<std::uint32_t>();
+        if (!word_count) return {};
+        std::vector<block_storage::word_type> words;
+        words.reserve(*word_count);
+        for (std::size_t i = 0; i < *word_count; i++) {
+            auto word = reader.read<block_storage::word_type>();
+            if (!word) return {};
+            words.push_back(*word);
+        }
+
+        auto storage = block_storage::from_raw(std::move(palette), *bits,
+                                               std::move(words));
+        if (!storage) return {};
+        section = std::move(*storage);
+    }
+    if (!reader.at_end()) return {};
+
+    return Chunk{id, std::move(sections)};
+}
+}  // namespace
+
+RegionStorage::RegionStorage(fs::path directory)
+    : directory(std::move(directory)) {}
+
+RegionStorage::~RegionStorage() = default;
+
+RegionStorage::region_identifier RegionStorage::get_region(
+    chunk_identifier id) {
+    return {floor_div(id.x, region_size), floor_div(id.z, region_size)};
+}
+
+std::size_t RegionStorage::get_local_index(chunk_identifier id) {
+    auto [region_x, region_z] = get_region(id);
+    auto local_x = static_cast<std::size_t>(id.x - region_x * region_size);
+    auto local_z = static_cast<std::size_t>(id.z - region_z * region_size);
+    return local_x + region_size * local_z;
+}
+
+fs::path RegionStorage::region_path(chunk_identifier id) const {
+    auto [region_x, region_z] = get_region(id);
+    return directory / ("r." + std::to_string(region_x) + "." +
+                        std::to_string(region_z) + ".region");
+}
+
+RegionStorage::region_file& RegionStorage::get_region_file(
+    chunk_identifier id) {
+    std::scoped_lock lock{regions_mutex};
+    auto& region = regions[get_region(id)];
+    if (!region) region = std::make_unique<region_file>();
+    return *region;
+}
+
+const MappedFile* RegionStorage::get_mapping(region_file& region,
+                                             chunk_identifier id,
+                                             std::size_t min_size) {
+    if (region.mapping && region.mapping->size() >= min_size)
+        return region.mapping.get();
+
+    auto path = region_path(id);
+    if (!fs::exists(path)) return nullptr;
+
+    region.mapping = std::make_unique<MappedFile>(path);
+    return region.mapping.get();
+}
+
+std::optional<Chunk> RegionStorage::load(chunk_identifier id) {
+    auto& region = get_region_file(id);
+    std::scoped_lock lock{region.mutex};
+    try {
+        const auto* mapping =
+            get_mapping(region, id, header_sectors * sector_size);
+        if (mapping == nullptr) return {};
+
+        Reader header{mapping->data(), mapping->size()};
+        if (mapping->size() < header_sectors * sector_size ||
+            header.read<std::uint32_t>() != magic ||
+            header.read<std::uint32_t>() != version ||
+            header.read<std::uint32_t>() != region_size) {
+            log << LogLevel::Error << "Invalid region file "
+                << region_path(id).string();
+            return {};
+        }
+
+        Reader entry{mapping->data() + table_offset +  // NOLINT
+                         get_local_index(id) * table_entry_size,
+                     table_entry_size};
+        auto sector = *entry.read<std::uint32_t>();
+        auto length = *entry.read<std::uint32_t>();
+        if (length == 0) return {};  // never saved
+
+        std::size_t begin = sector * sector_size;
+        // Saved after the file was mapped
+        if (begin + length > mapping->size())
+            mapping = get_mapping(region, id, begin + length);
+        // The file may have been removed since
+        if (mapping == nullptr || begin + length > mapping->size()) {
+            log << LogLevel::Error << "Missing or truncated chunk " << id.x
+                << " " << id.z;
+            return {};
+        }
+
+        auto chunk = deserialize(id, mapping->data() + begin,  // NOLINT
+                                 length);
+        if (!chunk)
+            log << LogLevel::Error << "Corrupted chunk " << id.x << " "
+                << id.z;
+        return chunk;
+    } catch (const std::exception& e) {
+        log << LogLevel::Error << e.what();
+        return {};
+    }
+}
+
+void RegionStorage::save(const Chunk& chunk) {
+    PROFILE_SCOPED();
+    const auto id = chunk.getId();
+    scratch_arena<save_scratch> scratch;
+    auto& payload = scratch->payload;
+    serialize(chunk, payload);
+    const std::size_t payload_size = payload.size();
+    const std::size_t sectors_needed =
+        (payload_size + sector_size - 1) / sector_size;
+
+    auto& region = get_region_file(id);
+    std::scoped_lock lock{region.mutex};
+    try {
+        fs::create_directories(directory);
+        const auto path = region_path(id);
+        if (!fs::exists(path)) {
+            std::vector<std::byte> header;
+            write_value(header, magic);
+            write_value(header, version);
+            write_value(header, static_cast<std::uint32_t>(region_size));
+            header.resize(header_sectors * sector_size);
+
+            std::ofstream f(path, std::ios::binary);
+            f.write(reinterpret_cast<const char*>(header.data()),  // NOLINT
+                    static_cast<std::streamsize>(header.size()));
+        }
+
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        if (!f.is_open())
+            throw std::runtime_error("could not open " + path.string());
+
+        const auto entry_position = static_cast<std::streamoff>(
+            table_offset + get_local_index(id) * table_entry_size);
+        std::uint32_t sector = 0;
+        std::uint32_t length = 0;
+        f.seekg(entry_position);
+        f.read(reinterpret_cast<char*>(&sector), sizeof(sector));  // NOLINT
+        f.read(reinterpret_cast<char*>(&length), sizeof(length));  // NOLINT
+
+        // Reuse the old sectors if they are large enough, otherwise append.
+        // Sectors that become unused are not reclaimed
+        const std::size_t sectors_used =
+            (length + sector_size - 1) / sector_size;
+        if (length == 0 || sectors_used < sectors_needed) {
+            f.seekg(0, std::ios::end);
+            sector = static_cast<std::uint32_t>(
+                static_cast<std::size_t>(f.tellg()) / sector_size);
+        }
+        length = static_cast<std::uint32_t>(payload_size);
+
+        payload.resize(sectors_needed * sector_size);  // zero padding
+        f.seekp(static_cast<std::streamoff>(sector * sector_size));
+        f.write(reinterpret_cast<const char*>(payload.data()),  // NOLINT
+                static_cast<std::streamsize>(payload.size()));
+
+        f.seekp(entry_position);
+        f.write(reinterpret_cast<const char*>(&sector), sizeof(sector));  // NOLINT
+        f.write(reinterpret_cast<const char*>(&length), sizeof(length));  // NOLINT
+        if (!f) throw std::runtime_error("could not write " + path.string());
+        // A copy of the file does not see the write
+        if (!MappedFile::shared) region.mapping.reset();
+    } catch (const std::exception& e) {
+        log << LogLevel::Error << "Could not save chunk " << id.x << " "
+            << id.z << ": " << e.what();
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef REGION_STORAGE_H_
+#define REGION_STORAGE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "../component/chunk.h"
+#include "../utils/logging.h"
+#include "mapped_file.h"
+
+namespace fs = std::filesystem;
+
+// On disk storage of chunks, see docs/storage.md
+//
+// Chunks are grouped by regions of region_size x region_size chunks, one file
+// per region. A region file starts with a header:
+//   - magic, version and region_size, as 3 uint32
+//   - an offset table of region_size * region_size entries, one per chunk:
+//     uint32 first sector and uint32 length in bytes (0 if absent)
+// padded to a whole number of sectors. Chunks are stored in consecutive
+// sectors after the header.
+//
+// Region files are read through mmap: loading a chunk is a lookup in the offset
+// table and a copy of its sections out of the mapping. Saves write to the file,
+// the mapping sees them and is only remapped once the file grew past it.
+//
+// All the functions are thread safe, each region has its own lock.
+class RegionStorage {
+   public:
+    static constexpr int region_size = 32;
+    static constexpr std::size_t sector_size = 4096;
+    static constexpr std::uint32_t magic = 0x4752434d;  // "MCRG"
+    static constexpr std::uint32_t version = 1;
+
+    explicit RegionStorage(fs::path directory);
+    RegionStorage(const RegionStorage&) = delete;
+    RegionStorage& operator=(const RegionStorage&) = delete;
+    ~RegionStorage();
+
+    // Nothing if the chunk has never been saved
+    std::optional<Chunk> load(chunk_identifier id);
+    void save(const Chunk& chunk);
+
+    [[nodiscard]] fs::path region_path(chunk_identifier id) const;
+
+   private:
+    using region_identifier = std::pair<int, int>;
+    static region_identifier get_region(chunk_identifier id);
+    // Index of the chunk in the offset table of its region
+    static std::size_t get_local_index(chunk_identifier id);
+
+    struct region_file {
+        // Guards the mapping and the file
+        std::mutex mutex;
+        std::unique_ptr<MappedFile> mapping;
+    };
+    region_file& get_region_file(chunk_identifier id);
+    // The mapping of the region file, remapped if it is smaller than min_size.
+    // nullptr if the region file does not exist. The lock of the region must
+    // be held
+    const MappedFile* get_mapping(region_file& region, chunk_identifier id,
+                                  std::size_t min_size);
+
+    fs::path directory;
+    // Only guards the map, region files are never removed from it
+    std::mutex regions_mutex;
+    std::map<region_identifier, std::unique_ptr<region_file>> regions;
+    Logger log{Logger::get({"RegionStorage"})};
+};
+
+#endif  // !REGION_STORAGE_H_
@@ -0,0 +1,66 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+// Multi producer, multi consumer FIFO with a maximum size.
+// Producers block while the queue is full, consumers never block.
+template <typename T>
+class bounded_queue {
+   public:
+    explicit bounded_queue(std::size_t capacity) : capacity(capacity) {}
+    bounded_queue(const bounded_queue&) = delete;
+    bounded_queue& operator=(const bounded_queue&) = delete;
+
+    // Blocks until there is some room in the queue.
+    // Returns false if the queue has been closed, value is then dropped
+    bool push(T value) {
+        std::unique_lock lock{mutex};
+        not_full.wait(lock, [&] { return closed || queue.size() < capacity; });
+        if (closed) return false;
+
+        queue.push_back(std::move(value));
+        return true;
+    }
+
+    std::optional<T> try_pop() {
+        std::optional<T> value;
+        {
+            std::scoped_lock lock{mutex};
+            if (queue.empty()) return value;
+
+            value.emplace(std::move(queue.front()));
+            queue.pop_front();
+        }
+        not_full.notify_one();
+        return value;
+    }
+
+    // Wakes up and rejects every producer, current and future
+    void close() {
+        {
+            std::scoped_lock lock{mutex};
+            closed = true;
+        }
+        not_full.notify_all();
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        std::scoped_lock lock{mutex};
+        return queue.size();
+    }
+
+   private:
+    mutable std::mutex mutex;
+    std::condition_variable not_full;
+    std::deque<T> queue;
+    const std::size_t capacity;
+    bool closed = false;
+};
+
+#endif  // !BOUNDED_QUEUE_H
@@ -6,71 +6,44 @@
 #include <cstdlib>
 #include <functional>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "engine/utils/logging.h"
 
 const unsigned int default_half_size = 12;
 
+struct chunk_identifier {
+    int x;
+    int z;
+
+    bool operator==(const chunk_identifier&) const = default;
+};
+
+struct chunk_identifier_hash {
+    std::size_t operator()(const chunk_identifier& id) const {
+        return std::hash<long long>{}(
+            (static_cast<long long>(id.x) << 32) ^
+            static_cast<unsigned int>(id.z));
+    }
+};
+
+// Division and modulo rounded towards negative infinity, for b > 0: the chunk
+// of a block and the block in its chunk, or the region of a chunk
+constexpr int floor_div(int a, int b) { return a / b - (a % b < 0 ? 1 : 0); }
+constexpr int positive_modulo(int a, int b) { return ((a % b) + b) % b; }
+
 template <typename T>
 class chunk_array {
    private:
-    std::vector<std::vector<T>> data;
+    // size() * size() elements, element (i, j) is at i * size() + j
+    std::vector<T> data;
     std::function<T(int, int)> factory;
+    std::function<void(T&&)> evict_callback;
 
    public:
-    class chunk_array_it {
-       public:
-        using value_type = decltype(data);
-        static chunk_array_it begin(chunk_array* c) {
-            value_type* vv = &(c->data);
-            auto outer = vv->begin();
-            return chunk_array_it{outer, outer->begin(), vv};
-        }
-        static chunk_array_it end(chunk_array* c) {
-            value_type* vv = &(c->data);
-            return chunk_array_it{vv->end(), {}, vv};
-        }
-        chunk_array_it operator++(int) {  // postfix++
-            chunk_array_it ret = *this;
-            ++(*this);
-            return ret;
-        }
-        chunk_array_it& operator++() {  // ++prefix
-            inner++;
-            while (outer != vv->end() && inner == outer->end()) {
-                outer++;
-                if (outer != vv->end()) inner = outer->begin();
-            }
-            return *this;
-        }
-
-        friend bool operator==(const chunk_array_it& lhs,
-                               const chunk_array_it& rhs) {
-            if (lhs.outer == lhs.vv->end()) return lhs.outer == rhs.outer;
-            return (lhs.outer == rhs.outer) && (lhs.inner == rhs.inner);
-        }
-        friend bool operator!=(const chunk_array_it& lhs,
-                               const chunk_array_it& rhs) {
-            return !(lhs == rhs);
-        }
-
-        typename value_type::value_type::value_type& operator*() {
-            return *inner;
-        }
-
-       private:
-        typename value_type::iterator outer;
-        typename value_type::value_type::iterator inner;
-        value_type* vv;
-        chunk_array_it(chunk_array_it&) = default;
-        chunk_array_it(typename value_type::iterator outer,
-                       typename value_type::value_type::iterator inner,
-                       value_type* vv)
-            : outer(outer), inner(inner), vv(vv) {}
-    };
-
-    using iterator = chunk_array_it;
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
     using value_type = T;
 
     chunk_array(unsigned int half_size = default_half_size)
@@ -81,14 +54,41 @@ class chunk_array {
         resize_emplace();
     }
 
+    // Called with the elements that get out of the window, just before they
+    // are replaced
+    void set_evict_callback(std::function<void(T&&)> f) { evict_callback = f; }
+
     [[nodiscard]] unsigned int size() const { return 2 * half_size + 1; }
 
+    // The array is toroidal: an element is always stored at the indices
+    // (x mod size, y mod size). Thus moving only has to call the factory for
+    // the rows and columns that get exposed, and they reuse the slots of the
+    // ones that got out of range. See poc/circular_array.py
     void move_current_position(int x_rel, int y_rel) {
-        if(!x_rel && ! y_rel)
-            return;
+        if (!x_rel && !y_rel) return;
+        auto old_position = current_position;
         current_position.x += x_rel;
         current_position.y += y_rel;
-        resize_emplace();
+
+        const int full_size = static_cast<int>(size());
+        if (std::abs(x_rel) >= full_size || std::abs(y_rel) >= full_size) {
+            resize_emplace();
+            return;
+        }
+
+        const int half = static_cast<int>(half_size);
+        for (std::size_t i = 0; i < size(); i++) {
+            for (std::size_t j = 0; j < size(); j++) {
+                auto [x, y] = get_id_from_indices(i, j);
+                if (std::abs(x - old_position.x) <= half &&
+                    std::abs(y - old_position.y) <= half)
+                    continue;  // was already loaded
+
+                auto& element = data[flat_index(i, j)];
+                if (evict_callback) evict_callback(std::move(element));
+                element = factory(x, y);
+            }
+        }
     }
 
     void set_current_position(int abs_x, int abs_y) {
@@ -96,42 +96,78 @@ class chunk_array {
                               abs_y - current_position.y);
     }
 
-    iterator begin() { return chunk_array_it::begin(this); }
+    [[nodiscard]] chunk_identifier get_current_position() const {
+        return {current_position.x, current_position.y};
+    }
 
-    iterator end() { return chunk_array_it::end(this); }
+    [[nodiscard]] bool is_resident(chunk_identifier id) const {
+        const int half = static_cast<int>(half_size);
+        return std::abs(id.x - current_position.x) <= half &&
+               std::abs(id.z - current_position.y) <= half;
+    }
+
+    // O(1) access to the element of a chunk, nullptr if it is not resident
+    [[nodiscard]] T* find(chunk_identifier id) {
+        if (!is_resident(id)) return nullptr;
+        auto [i, j] = get_indices_from_id(id.x, id.z);
+        return &data[flat_index(i, j)];
+    }
+
+    [[nodiscard]] const T* find(chunk_identifier id) const {
+        return const_cast<chunk_array*>(this)->find(id);  // NOLINT
+    }
+
+    [[nodiscard]] T* at(int x, int z) { return find({x, z}); }
+    [[nodiscard]] const T* at(int x, int z) const { return find({x, z}); }
+
+    iterator begin() { return data.begin(); }
+    iterator end() { return data.end(); }
+    const_iterator begin() const { return data.begin(); }
+    const_iterator end() const { return data.end(); }
 
    private:
+    [[nodiscard]] std::size_t flat_index(std::size_t i, std::size_t j) const {
+        return i * size() + j;
+    }
+
     [[nodiscard]] std::pair<int, int> get_id_from_indices(std::size_t i,
                                                           std::size_t j) const {
         auto [current_i, current_j] =
             get_indices_from_id(current_position.x, current_position.y);
 
-        auto di = static_cast<int>(i) - static_cast<int>(current_i);
-        auto dj = static_cast<int>(j) - static_cast<int>(current_j);
+        // offsets of (i, j) from the current position, in [-half_size,
+        // half_size]
+        auto di = positive_modulo(
+            static_cast<int>(i) - static_cast<int>(current_i));
+        auto dj = positive_modulo(
+            static_cast<int>(j) - static_cast<int>(current_j));
 
-        if(di > static_cast<int>(half_size))
-            di -= size();
-        if(dj > static_cast<int>(half_size))
-            dj -= size();
+        if (di > static_cast<int>(half_size)) di -= static_cast<int>(size());
+        if (dj > static_cast<int>(half_size)) dj -= static_cast<int>(size());
 
         return {current_position.x + di, current_position.y + dj};
     }
 
     [[nodiscard]] std::pair<std::size_t, std::size_t> get_indices_from_id(
         int x, int y) const {
-        return {x  % size(), y % size()};
+        return {static_cast<std::size_t>(positive_modulo(x)),
+                static_cast<std::size_t>(positive_modulo(y))};
+    }
+
+    [[nodiscard]] int positive_modulo(int x) const {
+        return ::positive_modulo(x, static_cast<int>(size()));
     }
 
     void resize_emplace() {
+        if (evict_callback)
+            for (auto& element : data) evict_callback(std::move(element));
         data.clear();
-        data.reserve(size());
+        data.reserve(size() * size());
 
         for (std::size_t i = 0; i < size(); i++) {
-            data.emplace_back();
-            data[i].reserve(size());
             for (std::size_t j = 0; j < size(); j++) {
                 auto [x, y] = get_id_from_indices(i, j);
-                data[i].emplace_back(factory(x, y));  // Will use move ctor
+                data.emplace_back(factory(x, y));  // Will use move ctor
             }
         }
     }
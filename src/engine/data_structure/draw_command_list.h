@@ -0,0 +1,58 @@
+#ifndef DRAW_COMMAND_LIST_H
+#define DRAW_COMMAND_LIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Same layout as the DrawElementsIndirectCommand of OpenGL
+struct draw_elements_command {
+    std::uint32_t count;
+    std::uint32_t instance_count;
+    std::uint32_t first_index;
+    std::int32_t base_vertex;
+    std::uint32_t base_instance;
+};
+static_assert(sizeof(draw_elements_command) == 5 * sizeof(std::uint32_t));
+
+// The draws of a glMultiDrawElementsIndirect, built on the CPU every frame.
+// Each draw has an Instance, read by the shader as an instanced attribute:
+// the base instance of a draw is the index of its Instance
+template <typename Instance>
+class draw_command_list {
+   public:
+    void clear() {
+        draw_commands.clear();
+        draw_instances.clear();
+    }
+
+    // index_count indices of the shared index buffer, added to first_vertex
+    void add(std::size_t index_count, std::size_t first_vertex,
+             const Instance& instance) {
+        if (index_count == 0) return;
+
+        draw_commands.push_back({
+            .count = static_cast<std::uint32_t>(index_count),
+            .instance_count = 1,
+            .first_index = 0,
+            .base_vertex = static_cast<std::int32_t>(first_vertex),
+            .base_instance = static_cast<std::uint32_t>(draw_instances.size()),
+        });
+        draw_instances.push_back(instance);
+    }
+
+    [[nodiscard]] const std::vector<draw_elements_command>& commands() const {
+        return draw_commands;
+    }
+    [[nodiscard]] const std::vector<Instance>& instances() const {
+        return draw_instances;
+    }
+    [[nodiscard]] std::size_t size() const { return draw_commands.size(); }
+    [[nodiscard]] bool empty() const { return draw_commands.empty(); }
+
+   private:
+    std::vector<draw_elements_command> draw_commands;
+    std::vector<Instance> draw_instances;
+};
+
+#endif  // !DRAW_COMMAND_LIST_H
@@ -0,0 +1,94 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+// Cache bounded by the size in bytes of its values, the least recently
+// inserted or accessed values are evicted first.
+// Values are taken out of the cache on a hit, as they are moved back to their
+// owner.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class lru_cache {
+   public:
+    explicit lru_cache(std::size_t capacity_bytes)
+        : capacity_bytes(capacity_bytes) {}
+
+    // Values bigger than the whole cache are dropped
+    void put(const K& key, V value, std::size_t bytes) {
+        erase(key);
+        if (bytes > capacity_bytes) return;
+
+        entries.push_front({key, std::move(value), bytes});
+        index.emplace(key, entries.begin());
+        current_bytes += bytes;
+
+        while (current_bytes > capacity_bytes) {
+            auto& oldest = entries.back();
+            current_bytes -= oldest.bytes;
+            index.erase(oldest.key);
+            entries.pop_back();
+            evictions++;
+        }
+    }
+
+    std::optional<V> take(const K& key) {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            misses++;
+            return {};
+        }
+        hits++;
+
+        std::optional<V> value{std::move(it->second->value)};
+        current_bytes -= it->second->bytes;
+        entries.erase(it->second);
+        index.erase(it);
+        return value;
+    }
+
+    void erase(const K& key) {
+        auto it = index.find(key);
+        if (it == index.end()) return;
+
+        current_bytes -= it->second->bytes;
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    void clear() {
+        entries.clear();
+        index.clear();
+        current_bytes = 0;
+    }
+
+    [[nodiscard]] std::size_t size() const { return entries.size(); }
+    [[nodiscard]] std::size_t bytes() const { return current_bytes; }
+    [[nodiscard]] std::size_t capacity() const { return capacity_bytes; }
+    [[nodiscard]] std::size_t hit_count() const { return hits; }
+    [[nodiscard]] std::size_t miss_count() const { return misses; }
+    [[nodiscard]] std::size_t eviction_count() const { return evictions; }
+
+   private:
+    struct entry {
+        K key;
+        V value;
+        std::size_t bytes;
+    };
+
+    // Most recent first
+    std::list<entry> entries;
+    std::unordered_map<K, typename std::list<entry>::iterator, Hash> index;
+
+    const std::size_t capacity_bytes;
+    std::size_t current_bytes = 0;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t evictions = 0;
+};
+
+#endif  // !LRU_CACHE_H
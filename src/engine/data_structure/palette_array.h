@@ -0,0 +1,187 @@
+#ifndef PALETTE_ARRAY_H
+#define PALETTE_ARRAY_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Fixed size array of T, stored as indices into a local palette.
+//
+// Indices are bit packed into 64 bits words and never span two words, so
+// reading an element is a division, a shift and a mask. The index width starts
+// at 0 bits (the whole array is the only palette entry) and only grows when
+// the palette is full, at which point every index is repacked.
+//
+// T is expected to be small and cheap to compare (BlockData for instance)
+template <typename T, std::size_t Size>
+class palette_array {
+   public:
+    using value_type = T;
+    using word_type = std::uint64_t;
+    static constexpr std::size_t word_bits = 8 * sizeof(word_type);
+    static constexpr std::size_t max_bits = 16;
+
+    palette_array(const T& value = {}) : palette{value} {}
+
+    [[nodiscard]] static constexpr std::size_t size() { return Size; }
+
+    [[nodiscard]] T get(std::size_t i) const {
+        assert(i < Size);
+        return palette[get_index(i)];
+    }
+
+    void set(std::size_t i, const T& value) {
+        assert(i < Size);
+        set_index(i, get_or_insert_palette_index(value));
+    }
+
+    // Reset the whole array to value, this frees the packed indices
+    void fill(const T& value) {
+        palette.assign(1, value);
+        bits = 0;
+        words.clear();
+        words.shrink_to_fit();
+    }
+
+    // Drops the palette entries that are not used anymore and shrinks the
+    // indices accordingly. Afterwards, is_uniform() is exact.
+    void compact() {
+        if (bits == 0) return;
+
+        const std::size_t unused = palette.size();
+        std::vector<std::size_t> remap(palette.size(), unused);
+        std::vector<T> new_palette;
+        for (std::size_t i = 0; i < Size; i++) {
+            auto& new_index = remap[get_index(i)];
+            if (new_index == unused) {
+                new_index = new_palette.size();
+                new_palette.push_back(palette[get_index(i)]);
+            }
+        }
+        if (new_palette.size() == palette.size()) return;
+
+        std::size_t new_bits = 0;
+        while ((std::size_t{1} << new_bits) < new_palette.size()) new_bits++;
+
+        palette_array compacted{new_palette[0]};
+        compacted.palette = std::move(new_palette);
+        compacted.bits = new_bits;
+        compacted.words.resize(words_needed(new_bits));
+        for (std::size_t i = 0; i < Size; i++)
+            compacted.set_index(i, remap[get_index(i)]);
+
+        *this = std::move(compacted);
+    }
+
+    // True if all the elements are the same, without having to read them
+    [[nodiscard]] bool is_uniform() const { return bits == 0; }
+
+    [[nodiscard]] std::size_t palette_size() const { return palette.size(); }
+    [[nodiscard]] std::size_t bits_per_index() const { return bits; }
+
+    // Raw representation, for serialization
+    [[nodiscard]] const std::vector<T>& raw_palette() const { return palette; }
+    [[nodiscard]] const std::vector<word_type>& raw_words() const {
+        return words;
+    }
+
+    // Inverse of raw_palette/bits_per_index/raw_words.
+    // Returns nothing if they are not consistent
+    static std::optional<palette_array> from_raw(std::vector<T> palette,
+                                                 std::size_t bits,
+                                                 std::vector<word_type> words) {
+        if (palette.empty() || bits > max_bits ||
+            palette.size() > (std::size_t{1} << bits) ||
+            words.size() != words_needed(bits))
+            return {};
+
+        palette_array res;
+        res.palette = std::move(palette);
+        res.bits = bits;
+        res.words = std::move(words);
+        // an index past the end of the palette would be read out of bounds
+        for (std::size_t i = 0; i < Size; i++)
+            if (res.get_index(i) >= res.palette.size()) return {};
+        return res;
+    }
+
+    // Heap + inline memory used by this array
+    [[nodiscard]] std::size_t bytes() const {
+        return sizeof(*this) + palette.capacity() * sizeof(T) +
+               words.capacity() * sizeof(word_type);
+    }
+
+   private:
+    [[nodiscard]] static constexpr std::size_t indices_per_word(
+        std::size_t bits_) {
+        return word_bits / bits_;
+    }
+
+    [[nodiscard]] static constexpr std::size_t words_needed(std::size_t bits_) {
+        if (bits_ == 0) return 0;
+        return (Size + indices_per_word(bits_) - 1) / indices_per_word(bits_);
+    }
+
+    [[nodiscard]] std::size_t get_index(std::size_t i) const {
+        if (bits == 0) return 0;
+
+        const std::size_t per_word = indices_per_word(bits);
+        const word_type mask = (word_type{1} << bits) - 1;
+        return (words[i / per_word] >> ((i % per_word) * bits)) & mask;
+    }
+
+    void set_index(std::size_t i, std::size_t index) {
+        if (bits == 0) return;  // index can only be 0
+
+        const std::size_t per_word = indices_per_word(bits);
+        const std::size_t shift = (i % per_word) * bits;
+        const word_type mask = ((word_type{1} << bits) - 1) << shift;
+
+        word_type& word = words[i / per_word];
+        word = (word & ~mask) | ((static_cast<word_type>(index) << shift) & mask);
+    }
+
+    std::size_t get_or_insert_palette_index(const T& value) {
+        auto it = std::find(palette.begin(), palette.end(), value);
+        if (it != palette.end())
+            return static_cast<std::size_t>(it - palette.begin());
+
+        palette.push_back(value);
+        if (palette.size() > (std::size_t{1} << bits)) grow();
+        return palette.size() - 1;
+    }
+
+    // Adds one bit to every index
+    void grow() {
+        const std::size_t new_bits = bits + 1;
+        assert(new_bits <= max_bits);
+
+        std::vector<word_type> old_words(words_needed(new_bits));
+        std::swap(old_words, words);
+        const std::size_t old_bits = bits;
+
+        if (old_bits != 0) {
+            const std::size_t old_per_word = indices_per_word(old_bits);
+            const word_type old_mask = (word_type{1} << old_bits) - 1;
+
+            bits = new_bits;
+            for (std::size_t i = 0; i < Size; i++) {
+                set_index(i, (old_words[i / old_per_word] >>
+                              ((i % old_per_word) * old_bits)) &
+                                 old_mask);
+            }
+        }
+        // else every index was 0, and the new words already are 0
+        bits = new_bits;
+    }
+
+    std::vector<T> palette;
+    std::vector<word_type> words;
+    std::size_t bits = 0;
+};
+
+#endif  // !PALETTE_ARRAY_H
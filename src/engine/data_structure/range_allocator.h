@@ -0,0 +1,86 @@
+#ifndef RANGE_ALLOCATOR_H
+#define RANGE_ALLOCATOR_H
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <optional>
+
+// Sub allocator of a buffer of capacity units, for instance the vertices of a
+// GPU buffer shared by many meshes. Hands out ranges of consecutive units,
+// first fit.
+//
+// The free ranges are kept in a free list ordered by offset, a released range
+// is merged with the free ranges around it so that the buffer does not end up
+// cut in small pieces
+class range_allocator {
+   public:
+    explicit range_allocator(std::size_t capacity = 0) { grow(capacity); }
+
+    // Offset of the first unit of the range. Nothing if no free range is large
+    // enough, see grow
+    std::optional<std::size_t> allocate(std::size_t size) {
+        assert(size > 0);
+        for (auto it = free_ranges.begin(); it != free_ranges.end(); ++it) {
+            const auto [offset, free_size] = *it;
+            if (free_size < size) continue;
+
+            free_ranges.erase(it);
+            if (free_size > size)
+                free_ranges.emplace(offset + size, free_size - size);
+            used_units += size;
+            return offset;
+        }
+        return {};
+    }
+
+    // The range must have been allocated, and not released yet
+    void release(std::size_t offset, std::size_t size) {
+        assert(size > 0 && offset + size <= capacity_units);
+        assert(used_units >= size);
+        used_units -= size;
+
+        auto next = free_ranges.lower_bound(offset);
+        assert(next == free_ranges.end() || offset + size <= next->first);
+        if (next != free_ranges.end() && offset + size == next->first) {
+            size += next->second;
+            next = free_ranges.erase(next);
+        }
+        if (next != free_ranges.begin()) {
+            auto previous = std::prev(next);
+            assert(previous->first + previous->second <= offset);
+            if (previous->first + previous->second == offset) {
+                previous->second += size;
+                return;
+            }
+        }
+        free_ranges.emplace_hint(next, offset, size);
+    }
+
+    // Adds free units at the end of the buffer
+    void grow(std::size_t new_capacity) {
+        assert(new_capacity >= capacity_units);
+        if (new_capacity == capacity_units) return;
+
+        const std::size_t offset = capacity_units;
+        const std::size_t added = new_capacity - capacity_units;
+        capacity_units = new_capacity;
+        used_units += added;
+        release(offset, added);
+    }
+
+    [[nodiscard]] std::size_t capacity() const { return capacity_units; }
+    [[nodiscard]] std::size_t used() const { return used_units; }
+    [[nodiscard]] std::size_t free_range_count() const {
+        return free_ranges.size();
+    }
+
+   private:
+    // Size of the free ranges, by offset
+    std::map<std::size_t, std::size_t> free_ranges;
+    std::size_t capacity_units = 0;
+    std::size_t used_units = 0;
+};
+
+#endif  // !RANGE_ALLOCATOR_H
@@ -0,0 +1,45 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+// The last capacity values pushed, for instance the statistics of the last
+// frames. Once full, a push overwrites the oldest value. Index 0 is the
+// oldest value
+template <typename T>
+class ring_buffer {
+   public:
+    explicit ring_buffer(std::size_t capacity) : values(capacity) {
+        assert(capacity > 0);
+    }
+
+    void push_back(const T& value) {
+        values[next] = value;
+        next = (next + 1) % values.size();
+        if (count < values.size()) count++;
+    }
+    void clear() {
+        next = 0;
+        count = 0;
+    }
+
+    [[nodiscard]] const T& operator[](std::size_t i) const {
+        assert(i < count);
+        return values[(next + values.size() - count + i) % values.size()];
+    }
+    [[nodiscard]] const T& back() const { return (*this)[count - 1]; }
+
+    [[nodiscard]] std::size_t size() const { return count; }
+    [[nodiscard]] std::size_t capacity() const { return values.size(); }
+    [[nodiscard]] bool empty() const { return count == 0; }
+
+   private:
+    std::vector<T> values;
+    // Where the next value goes
+    std::size_t next = 0;
+    std::size_t count = 0;
+};
+
+#endif  // !RING_BUFFER_H
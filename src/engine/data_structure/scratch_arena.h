@@ -0,0 +1,45 @@
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#include <cassert>
+
+// Working buffers of a hot path, reused from one call to the next instead of
+// being allocated every time. Each thread has its own Buffers, so that the
+// workers do not share them: once the buffers have grown to their working
+// size, the hot path does not allocate anymore.
+//
+// Buffers is a struct of containers, which keep their capacity when they are
+// cleared. The buffers of a thread are borrowed for the duration of a scope,
+// and can not be borrowed again by the same thread before that:
+//
+//   scratch_arena<meshing_buffers> scratch;
+//   scratch->vertices.clear();
+template <typename Buffers>
+class scratch_arena {
+   public:
+    scratch_arena() : state(local()) {
+        assert(!state.borrowed && "nested use of the same scratch buffers");
+        state.borrowed = true;
+    }
+    scratch_arena(const scratch_arena&) = delete;
+    scratch_arena& operator=(const scratch_arena&) = delete;
+    ~scratch_arena() { state.borrowed = false; }
+
+    Buffers& operator*() { return state.buffers; }
+    Buffers* operator->() { return &state.buffers; }
+
+   private:
+    struct thread_state {
+        Buffers buffers{};
+        bool borrowed = false;
+    };
+
+    static thread_state& local() {
+        thread_local thread_state state;
+        return state;
+    }
+
+    thread_state& state;
+};
+
+#endif  // !SCRATCH_ARENA_H
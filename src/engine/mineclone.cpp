@@ -8,8 +8,11 @@
 #include <imgui.h>
 
 #include <chrono>
+#include <cmath>
 #include <exception>
+#include <fstream>
 #include <iostream>
+#include <vector>
 
 #include "data/camera_event.h"
 #include "system/event_manager.h"
@@ -23,7 +26,7 @@ Mineclone::Mineclone() {
     auto createWindow = [&]() -> WinInitError {
         glfwInit();
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
         glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
         glfwWindowHint(GLFW_RESIZABLE, GL_TRUE);
@@ -50,7 +53,7 @@ Mineclone::Mineclone() {
             break;
     }
 
-    renderer = std::make_unique<Renderer>();
+    renderer = std::make_unique<Renderer>(device);
 
     {  // Set Resize Callback
         auto resize_callback = [](GLFWwindow* window, int width, int height) {
@@ -120,13 +123,69 @@ void convertDispatchEvent(GLFWwindow* mWindow) {
     EventManager::dispatch(ev);
 }
 
-void runImGui(GLFWwindow* mWindow) {
+void runRenderStats(const render_stats_history& frame_stats) {
+    if (frame_stats.empty()) return;
+
+    const auto& last = frame_stats.back();
+    ImGui::Text("%zu draw calls, %zu draws, %zu uniform writes",
+                last.draw_calls, last.draws, last.uniform_writes);
+    ImGui::Text("%zu state changes, %zu KiB uploaded", last.state_changes,
+                last.bytes_uploaded / 1024);
+
+    std::vector<float> state_changes(frame_stats.size());
+    for (std::size_t i = 0; i < frame_stats.size(); i++)
+        state_changes[i] = static_cast<float>(frame_stats[i].state_changes);
+    ImGui::PlotLines("State changes", state_changes.data(),
+                     static_cast<int>(state_changes.size()));
+
+    if (ImGui::Button("Dump render stats")) {
+        static const char* const path = "render_stats.csv";
+        std::ofstream out{path};
+        writeCsv(out, frame_stats);
+        Logger::get({"Mineclone"})
+            << LogLevel::Info << "Render stats of the last "
+            << frame_stats.size() << " frames written to " << path;
+    }
+}
+
+void runImGui(GLFWwindow* mWindow, Renderer& renderer,
+              const render_stats_history& frame_stats) {
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 
     ImGui::Begin("ToolBar");
     if (ImGui::Button("Exit")) glfwSetWindowShouldClose(mWindow, true);
+
+    auto& world = renderer.getWorld();
+    bool greedy = world.get_meshing_mode() == MeshingMode::Greedy;
+    if (ImGui::Checkbox("Greedy meshing", &greedy))
+        world.set_meshing_mode(greedy ? MeshingMode::Greedy
+                                      : MeshingMode::PerFace);
+    ImGui::Text("%zu vertices", world.vertex_count());
+    ImGui::Text("%zu / %zu arena vertices", world.arena_used(),
+                world.arena_capacity());
+    bool occlusion_culling = world.get_occlusion_culling();
+    if (ImGui::Checkbox("Occlusion culling", &occlusion_culling))
+        world.set_occlusion_culling(occlusion_culling);
+    ImGui::Text("%zu chunks drawn, %zu culled, %zu draws", world.drawn_chunks(),
+                world.culled_chunks(), world.draw_count());
+    runRenderStats(frame_stats);
+
+    // Edits the top of the column under the player
+    const auto& position = renderer.getPlayerPosition();
+    const float x = position[0];
+    const float z = position[2];
+    if (auto height = world.surface_height(x, z)) {
+        const auto block_x = static_cast<int>(std::floor(x));
+        const auto block_z = static_cast<int>(std::floor(z));
+        if (ImGui::Button("Place block"))
+            world.set_block(block_x, *height + 1, block_z, {BlockType::Grass});
+        ImGui::SameLine();
+        if (ImGui::Button("Remove block"))
+            world.set_block(block_x, *height, block_z, {BlockType::Empty});
+    }
+    ImGui::Text("%.2f ms/frame", 1000.F / ImGui::GetIO().Framerate);
     ImGui::End();
 
     ImGui::Render();
@@ -143,8 +202,11 @@ void Mineclone::run() {
         convertDispatchEvent(mWindow);
         renderer->update(frame_duration.count());
         renderer->render();
+        // ImGui draws on its own, it is not part of the stats
+        frame_stats.push_back(device.stats());
+        device.resetStats();
 
-        runImGui(mWindow);
+        runImGui(mWindow, *renderer, frame_stats);
 
         glfwSwapBuffers(mWindow);
         glfwPollEvents();
@@ -7,6 +7,9 @@
 
 #include <memory>
 
+#include "component/gl_render_device.h"
+#include "component/recording_render_device.h"
+#include "component/render_stats.h"
 #include "system/event_manager.h"
 #include "system/renderer.h"
 #include "utils/logging.h"
@@ -18,6 +21,12 @@ class Mineclone {
     void run();
 
    private:
+    // Declared first, the renderer uses them until its destruction
+    GLRenderDevice gl_device{"./cache/program"};
+    RecordingRenderDevice device{&gl_device};
+    // What the renderer submitted during the last frames
+    static const std::size_t frame_stats_capacity = 600;
+    render_stats_history frame_stats{frame_stats_capacity};
     std::unique_ptr<Renderer> renderer;
     GLFWwindow *mWindow = nullptr;
     Logger log{Logger::get({"Mineclone"})};
@@ -62,6 +62,14 @@ class CameraController {
         return camera.self.rotation;
     }
 
+    // Direction the camera is looking at, in world space
+    [[nodiscard]] constexpr math::vec3f get_view_direction() const {
+        // The camera looks toward -z in view space, and rows of the rotation
+        // are the view space axes expressed in world space
+        auto rotation = get_rotation();
+        return {-rotation[2][0], -rotation[2][1], -rotation[2][2]};
+    }
+
     [[nodiscard]] constexpr math::mat4f getCameraMatrix() const {
         // We move world by -transl, this the same effect as moving camera by
         // transl;
@@ -0,0 +1,103 @@
+#ifndef CHUNK_LOAD_SCHEDULER_H_
+#define CHUNK_LOAD_SCHEDULER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "../data_structure/chunk_array.h"
+#include "../utils/mat.h"
+
+// Orders the chunks waiting to be built: nearest chunks first, and chunks in
+// front of the camera before the ones behind it. Chunks that are not wanted
+// anymore (out of the window after a move or a teleport) are dropped before
+// they reach a worker.
+class ChunkLoadScheduler {
+   public:
+    ChunkLoadScheduler(int chunk_width) : chunk_width(chunk_width) {}
+
+    void request(chunk_identifier id) {
+        pending.push_back({id, priority(id)});
+        sorted = false;
+    }
+
+    // Drops the chunks for which is_wanted returns false, and recomputes the
+    // priorities for the new position of the viewer.
+    // view_direction is expected to be normalized
+    void update(const math::vec3f& position, const math::vec3f& view_direction,
+                const std::function<bool(chunk_identifier)>& is_wanted) {
+        viewer_position = position;
+        viewer_direction = view_direction;
+
+        auto stale = std::remove_if(
+            pending.begin(), pending.end(),
+            [&](const pending_chunk& p) { return !is_wanted(p.id); });
+        cancelled += static_cast<std::size_t>(pending.end() - stale);
+        pending.erase(stale, pending.end());
+
+        for (auto& p : pending) p.priority = priority(p.id);
+        sorted = false;
+    }
+
+    // The most urgent chunk
+    std::optional<chunk_identifier> pop() {
+        if (pending.empty()) return {};
+        if (!sorted) {
+            // Most urgent is at the back
+            std::sort(pending.begin(), pending.end(),
+                      [](const pending_chunk& lhs, const pending_chunk& rhs) {
+                          return lhs.priority > rhs.priority;
+                      });
+            sorted = true;
+        }
+
+        auto id = pending.back().id;
+        pending.pop_back();
+        return id;
+    }
+
+    [[nodiscard]] std::size_t pending_count() const { return pending.size(); }
+    [[nodiscard]] std::size_t cancelled_count() const { return cancelled; }
+
+    // Chunks behind the viewer count as if they were that many times farther
+    static constexpr float behind_penalty = 4;
+
+   private:
+    struct pending_chunk {
+        chunk_identifier id;
+        float priority;  // lower is more urgent
+    };
+
+    [[nodiscard]] float priority(chunk_identifier id) const {
+        const float half_width = static_cast<float>(chunk_width) / 2;
+        const math::vec3f to_chunk{
+            static_cast<float>(id.x * chunk_width) + half_width -
+                viewer_position[0],
+            0,
+            static_cast<float>(id.z * chunk_width) + half_width -
+                viewer_position[2],
+        };
+
+        const float distance2 = math::norm2(to_chunk);
+        // The chunks right around the viewer are always needed
+        if (distance2 <= 2 * static_cast<float>(chunk_width * chunk_width))
+            return distance2;
+
+        const bool in_front = math::dot(to_chunk, viewer_direction) >= 0;
+        // distance2 is squared, so is the penalty
+        return in_front ? distance2
+                        : behind_penalty * behind_penalty * distance2;
+    }
+
+    const int chunk_width;
+    std::vector<pending_chunk> pending;
+    bool sorted = true;
+    std::size_t cancelled = 0;
+
+    math::vec3f viewer_position{};
+    math::vec3f viewer_direction{0, 0, -1};
+};
+
+#endif  // !CHUNK_LOAD_SCHEDULER_H_
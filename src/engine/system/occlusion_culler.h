@@ -0,0 +1,168 @@
+#ifndef OCCLUSION_CULLER_H_
+#define OCCLUSION_CULLER_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "../component/chunk.h"
+#include "../data_structure/chunk_array.h"
+#include "../utils/frustum.h"
+#include "../utils/mat.h"
+
+// Finds the sections that can be seen from the camera, walking through the
+// sections from the one of the camera, breadth first. A section is entered
+// through one of its faces, and left through the faces connected to it, see
+// section_visibility. The walk never goes back toward the camera, so that a
+// section is only seen through the sections between it and the camera. A
+// section entered through several faces is left through the faces connected
+// to any of them.
+//
+// This is conservative: sections hidden by a combination of walls rather than
+// by a single one are kept.
+class OcclusionCuller {
+   public:
+    // Visibility of the sections of a chunk, nullptr if the chunk is not
+    // meshed yet: it is seen through
+    using visibility_lookup =
+        std::function<const chunk_visibility*(chunk_identifier)>;
+
+    // Walks the chunks at most radius chunks away from the one of the camera.
+    // The sections out of frustum, if there is one, are neither visible nor
+    // walked through
+    void update(const math::vec3f& camera, int radius,
+                const visibility_lookup& lookup,
+                const math::frustum* frustum = nullptr) {
+        center = {chunkCoord(camera[0]), chunkCoord(camera[2])};
+        window_radius = radius;
+        const auto size = static_cast<std::size_t>(2 * radius + 1);
+        visible.assign(size * size, 0);
+        entered.assign(size * size * chunkSectionCount, 0);
+        visible_count = 0;
+
+        const int camera_section =
+            std::clamp(static_cast<int>(std::floor(camera[1])), 0,
+                       chunkHeight - 1) /
+            chunkSectionHeight;
+        queue.clear();
+        markVisible(center, camera_section);
+        entered[index(center, camera_section)] = allFaces;
+        queue.push_back({center, camera_section, {}, 0});
+
+        for (std::size_t next = 0; next < queue.size(); next++) {
+            const auto current = queue[next];
+            const chunk_visibility* chunk = lookup(current.chunk);
+            const auto& section =
+                chunk ? (*chunk)[static_cast<std::size_t>(current.section)]
+                      : section_visibility::all();
+
+            for (std::size_t i = 0; i < faceKindCount; i++) {
+                const auto face = static_cast<FaceKind>(i);
+                // Never toward the camera
+                if ((current.directions & faceMaskOf(oppositeFace(face))) != 0)
+                    continue;
+                if (current.from && !section.connected(*current.from, face))
+                    continue;
+
+                const auto [dx, dy, dz] = faceOffsets[i];
+                const chunk_identifier id{current.chunk.x + dx,
+                                          current.chunk.z + dz};
+                const int y = current.section + dy;
+                if (y < 0 || y >= chunkSectionCount || !inWindow(id)) continue;
+
+                const FaceKind from = oppositeFace(face);
+                auto& entered_faces = entered[index(id, y)];
+                if ((entered_faces & faceMaskOf(from)) != 0) continue;
+                if (entered_faces == 0) {
+                    if (frustum &&
+                        !math::intersects(*frustum, sectionBounds(id, y))) {
+                        entered_faces = allFaces;  // never to be tested again
+                        continue;
+                    }
+                    markVisible(id, y);
+                }
+                entered_faces |= faceMaskOf(from);
+                queue.push_back({id, y, from,
+                                 static_cast<face_mask>(current.directions |
+                                                        faceMaskOf(face))});
+            }
+        }
+    }
+
+    // Sections of the chunk seen at the last update
+    [[nodiscard]] section_mask visibleSections(chunk_identifier id) const {
+        if (!inWindow(id)) return 0;
+        return visible[index(id)];
+    }
+
+    [[nodiscard]] std::size_t visibleSectionCount() const {
+        return visible_count;
+    }
+
+   private:
+    struct step {
+        chunk_identifier chunk;
+        int section;
+        // Face through which the section was entered, none for the camera
+        std::optional<FaceKind> from;
+        // Directions taken since the camera
+        face_mask directions;
+    };
+
+    // Chunk and section offsets toward the faces, in FaceKind order
+    static constexpr std::array<std::array<int, 3>, faceKindCount> faceOffsets{
+        {
+            {0, 1, 0},   // Top
+            {0, -1, 0},  // Bottom
+            {0, 0, -1},  // Front
+            {0, 0, 1},   // Back
+            {-1, 0, 0},  // Left
+            {1, 0, 0},   // Right
+        }};
+
+    static int chunkCoord(float coord) {
+        return static_cast<int>(std::floor(coord / chunkWidth));
+    }
+
+    static math::aabb sectionBounds(chunk_identifier id, int section) {
+        const math::vec3f min{static_cast<float>(id.x * chunkWidth),
+                              static_cast<float>(section * chunkSectionHeight),
+                              static_cast<float>(id.z * chunkWidth)};
+        return {min, min + math::vec3f{chunkWidth, chunkSectionHeight,
+                                       chunkWidth}};
+    }
+
+    [[nodiscard]] bool inWindow(chunk_identifier id) const {
+        return std::abs(id.x - center.x) <= window_radius &&
+               std::abs(id.z - center.z) <= window_radius;
+    }
+    [[nodiscard]] std::size_t index(chunk_identifier id) const {
+        const auto size = static_cast<std::size_t>(2 * window_radius + 1);
+        return static_cast<std::size_t>(id.x - center.x + window_radius) *
+                   size +
+               static_cast<std::size_t>(id.z - center.z + window_radius);
+    }
+    [[nodiscard]] std::size_t index(chunk_identifier id, int section) const {
+        return index(id) * chunkSectionCount +
+               static_cast<std::size_t>(section);
+    }
+    void markVisible(chunk_identifier id, int section) {
+        visible[index(id)] |= section_mask{1} << section;
+        visible_count++;
+    }
+
+    chunk_identifier center{};
+    int window_radius = 0;
+    std::vector<section_mask> visible;
+    // Faces through which each section has been entered
+    std::vector<face_mask> entered;
+    std::size_t visible_count = 0;
+    std::vector<step> queue;
+};
+
+#endif  // !OCCLUSION_CULLER_H_
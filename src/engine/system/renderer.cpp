@@ -17,8 +17,8 @@ void Renderer::update(float dt) {
 
 void Renderer::render() {
     PROFILE_SCOPED_FPS();
-    glClearColor(0.f, 0.f, 0.f, 1.f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    device.clearColor(0.f, 0.f, 0.f, 1.f);
+    device.clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     world_renderer.render();
 }
@@ -1,13 +1,24 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include <filesystem>
+
+#include "../component/render_device.h"
 #include "camera_controller.h"
 #include "player_controller.h"
 #include "world.h"
 
 class Renderer {
    public:
-    Renderer() = default;
+    // The world is saved to and loaded from world_directory, the assets are
+    // baked into baked_directory
+    explicit Renderer(
+        RenderDevice &device,
+        const std::filesystem::path &world_directory = "./world",
+        const std::filesystem::path &baked_directory = "./cache/asset")
+        : device(device),
+          world_renderer{device, &camera_controller, &player_controller,
+                         world_directory, baked_directory} {}
     Renderer(Renderer &&) = delete;
     Renderer(const Renderer &) = delete;
     Renderer &operator=(Renderer &&) = delete;
@@ -18,10 +29,16 @@ class Renderer {
     void update(float dt);
     void setWindowSize(int width, int height);
 
+    World &getWorld() { return world_renderer; }
+    const math::vec3f &getPlayerPosition() const {
+        return player_controller.player.self.position;
+    }
+
    private:
+    RenderDevice &device;
     CameraController camera_controller;
     PlayerController player_controller{&camera_controller};
-    World world_renderer{&camera_controller, &player_controller};
+    World world_renderer;
     Logger log{Logger::get({"Renderer"})};
 };
 
@@ -0,0 +1,305 @@
+#include "terrain_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../utils/profiler.h"
+
+namespace {
+const int octave_count = 4;
+const std::array<float, octave_count> frequencies{1.F / 64, 1.F / 32,
+                                                  1.F / 16, 1.F / 8};
+const std::array<float, octave_count> amplitudes{16, 8, 4, 2};
+const float base_height = 4;
+
+// Every octave has its own lattice
+std::uint32_t octave_seed(std::uint32_t seed, int octave) {
+    return seed + static_cast<std::uint32_t>(octave) * 0x9e3779b9U;
+}
+
+// Integer hash of a lattice point. The vectorized versions below must stay in
+// sync with it
+std::uint32_t hash(std::int32_t x, std::int32_t z, std::uint32_t seed) {
+    std::uint32_t h = (static_cast<std::uint32_t>(x) * 0x27d4eb2dU) ^
+                      (static_cast<std::uint32_t>(z) * 0x165667b1U) ^ seed;
+    h ^= h >> 15;
+    h *= 0x2c1b3c6dU;
+    h ^= h >> 12;
+    h *= 0x297a2d39U;
+    h ^= h >> 15;
+    return h;
+}
+
+// To [0, 1), exactly representable as a float
+float to_unit(std::uint32_t h) {
+    return static_cast<float>(h >> 8) * (1.F / 16777216.F);
+}
+
+float value_noise(float x, float z, std::uint32_t seed) {
+    const float x0 = std::floor(x);
+    const float z0 = std::floor(z);
+    const auto xi = static_cast<std::int32_t>(x0);
+    const auto zi = static_cast<std::int32_t>(z0);
+
+    const float tx = x - x0;
+    const float tz = z - z0;
+    const float ux = tx * tx * (3.F - 2.F * tx);
+    const float uz = tz * tz * (3.F - 2.F * tz);
+
+    const float v00 = to_unit(hash(xi, zi, seed));
+    const float v10 = to_unit(hash(xi + 1, zi, seed));
+    const float v01 = to_unit(hash(xi, zi + 1, seed));
+    const float v11 = to_unit(hash(xi + 1, zi + 1, seed));
+
+    const float a = v00 + (v10 - v00) * ux;
+    const float b = v01 + (v11 - v01) * ux;
+    return a + (b - a) * uz;
+}
+
+int to_height(float h) {
+    return std::clamp(static_cast<int>(h), 0, chunkHeight - 1);
+}
+
+#if defined(__AVX2__)
+const char* const simd = "AVX2";
+const int lanes = 8;
+
+__m256i hash_v(__m256i x, __m256i z, __m256i seed) {
+    __m256i h = _mm256_xor_si256(
+        _mm256_xor_si256(_mm256_mullo_epi32(x, _mm256_set1_epi32(0x27d4eb2d)),
+                         _mm256_mullo_epi32(z, _mm256_set1_epi32(0x165667b1))),
+        seed);
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(0x2c1b3c6d));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 12));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(0x297a2d39));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+    return h;
+}
+
+__m256 to_unit_v(__m256i h) {
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(h, 8)),
+                         _mm256_set1_ps(1.F / 16777216.F));
+}
+
+__m256 value_noise_v(__m256 x, __m256 z, std::uint32_t seed) {
+    const __m256 x0 = _mm256_floor_ps(x);
+    const __m256 z0 = _mm256_floor_ps(z);
+    const __m256i xi = _mm256_cvtps_epi32(x0);
+    const __m256i zi = _mm256_cvtps_epi32(z0);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i seed_v = _mm256_set1_epi32(static_cast<int>(seed));
+
+    const __m256 three = _mm256_set1_ps(3.F);
+    const __m256 two = _mm256_set1_ps(2.F);
+    const __m256 tx = _mm256_sub_ps(x, x0);
+    const __m256 tz = _mm256_sub_ps(z, z0);
+    const __m256 ux = _mm256_mul_ps(_mm256_mul_ps(tx, tx),
+                                    _mm256_sub_ps(three, _mm256_mul_ps(two, tx)));
+    const __m256 uz = _mm256_mul_ps(_mm256_mul_ps(tz, tz),
+                                    _mm256_sub_ps(three, _mm256_mul_ps(two, tz)));
+
+    const __m256i xi1 = _mm256_add_epi32(xi, one);
+    const __m256i zi1 = _mm256_add_epi32(zi, one);
+    const __m256 v00 = to_unit_v(hash_v(xi, zi, seed_v));
+    const __m256 v10 = to_unit_v(hash_v(xi1, zi, seed_v));
+    const __m256 v01 = to_unit_v(hash_v(xi, zi1, seed_v));
+    const __m256 v11 = to_unit_v(hash_v(xi1, zi1, seed_v));
+
+    const __m256 a =
+        _mm256_add_ps(v00, _mm256_mul_ps(_mm256_sub_ps(v10, v00), ux));
+    const __m256 b =
+        _mm256_add_ps(v01, _mm256_mul_ps(_mm256_sub_ps(v11, v01), ux));
+    return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), uz));
+}
+
+// Heights of the lanes columns starting at (world_x, world_z)
+void heights_v(int world_x, int world_z, std::uint32_t seed, int* out) {
+    const __m256 x = _mm256_cvtepi32_ps(
+        _mm256_add_epi32(_mm256_set1_epi32(world_x),
+                         _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+    const __m256 z = _mm256_set1_ps(static_cast<float>(world_z));
+
+    __m256 h = _mm256_set1_ps(base_height);
+    for (int octave = 0; octave < octave_count; octave++) {
+        const __m256 frequency = _mm256_set1_ps(frequencies[octave]);
+        const __m256 noise =
+            value_noise_v(_mm256_mul_ps(x, frequency),
+                          _mm256_mul_ps(z, frequency),
+                          octave_seed(seed, octave));
+        h = _mm256_add_ps(
+            h, _mm256_mul_ps(_mm256_set1_ps(amplitudes[octave]), noise));
+    }
+
+    alignas(32) float res[lanes];  // NOLINT
+    _mm256_store_ps(res, h);
+    for (int i = 0; i < lanes; i++) out[i] = to_height(res[i]);  // NOLINT
+}
+#elif defined(__SSE2__)
+const char* const simd = "SSE2";
+const int lanes = 4;
+
+// SSE2 has no 32 bits low multiplication
+__m128i mullo_epi32(__m128i a, __m128i b) {
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd =
+        _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+__m128i hash_v(__m128i x, __m128i z, __m128i seed) {
+    __m128i h = _mm_xor_si128(
+        _mm_xor_si128(mullo_epi32(x, _mm_set1_epi32(0x27d4eb2d)),
+                      mullo_epi32(z, _mm_set1_epi32(0x165667b1))),
+        seed);
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+    h = mullo_epi32(h, _mm_set1_epi32(0x2c1b3c6d));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 12));
+    h = mullo_epi32(h, _mm_set1_epi32(0x297a2d39));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+    return h;
+}
+
+__m128 to_unit_v(__m128i h) {
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(h, 8)),
+                      _mm_set1_ps(1.F / 16777216.F));
+}
+
+// SSE2 has no floor, truncate and fix negative values
+__m128 floor_v(__m128 x) {
+    const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    const __m128 too_big = _mm_cmpgt_ps(truncated, x);
+    return _mm_sub_ps(truncated, _mm_and_ps(too_big, _mm_set1_ps(1.F)));
+}
+
+__m128 value_noise_v(__m128 x, __m128 z, std::uint32_t seed) {
+    const __m128 x0 = floor_v(x);
+    const __m128 z0 = floor_v(z);
+    const __m128i xi = _mm_cvttps_epi32(x0);
+    const __m128i zi = _mm_cvttps_epi32(z0);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i seed_v = _mm_set1_epi32(static_cast<int>(seed));
+
+    const __m128 three = _mm_set1_ps(3.F);
+    const __m128 two = _mm_set1_ps(2.F);
+    const __m128 tx = _mm_sub_ps(x, x0);
+    const __m128 tz = _mm_sub_ps(z, z0);
+    const __m128 ux =
+        _mm_mul_ps(_mm_mul_ps(tx, tx), _mm_sub_ps(three, _mm_mul_ps(two, tx)));
+    const __m128 uz =
+        _mm_mul_ps(_mm_mul_ps(tz, tz), _mm_sub_ps(three, _mm_mul_ps(two, tz)));
+
+    const __m128i xi1 = _mm_add_epi32(xi, one);
+    const __m128i zi1 = _mm_add_epi32(zi, one);
+    const __m128 v00 = to_unit_v(hash_v(xi, zi, seed_v));
+    const __m128 v10 = to_unit_v(hash_v(xi1, zi, seed_v));
+    const __m128 v01 = to_unit_v(hash_v(xi, zi1, seed_v));
+    const __m128 v11 = to_unit_v(hash_v(xi1, zi1, seed_v));
+
+    const __m128 a = _mm_add_ps(v00, _mm_mul_ps(_mm_sub_ps(v10, v00), ux));
+    const __m128 b = _mm_add_ps(v01, _mm_mul_ps(_mm_sub_ps(v11, v01), ux));
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), uz));
+}
+
+// Heights of the lanes columns starting at (world_x, world_z)
+void heights_v(int world_x, int world_z, std::uint32_t seed, int* out) {
+    const __m128 x = _mm_cvtepi32_ps(
+        _mm_add_epi32(_mm_set1_epi32(world_x), _mm_setr_epi32(0, 1, 2, 3)));
+    const __m128 z = _mm_set1_ps(static_cast<float>(world_z));
+
+    __m128 h = _mm_set1_ps(base_height);
+    for (int octave = 0; octave < octave_count; octave++) {
+        const __m128 frequency = _mm_set1_ps(frequencies[octave]);
+        const __m128 noise = value_noise_v(_mm_mul_ps(x, frequency),
+                                           _mm_mul_ps(z, frequency),
+                                           octave_seed(seed, octave));
+        h = _mm_add_ps(h,
+                       _mm_mul_ps(_mm_set1_ps(amplitudes[octave]), noise));
+    }
+
+    alignas(16) float res[lanes];  // NOLINT
+    _mm_store_ps(res, h);
+    for (int i = 0; i < lanes; i++) out[i] = to_height(res[i]);  // NOLINT
+}
+#else
+const char* const simd = "none";
+#endif
+
+float column_height(int world_x, int world_z, std::uint32_t seed) {
+    float h = base_height;
+    for (int octave = 0; octave < octave_count; octave++) {
+        const float frequency = frequencies[octave];
+        h += amplitudes[octave] *
+             value_noise(static_cast<float>(world_x) * frequency,
+                         static_cast<float>(world_z) * frequency,
+                         octave_seed(seed, octave));
+    }
+    return h;
+}
+}  // namespace
+
+const char* TerrainGenerator::simd_name() { return simd; }
+
+TerrainGenerator::heightmap TerrainGenerator::heights_scalar(
+    chunk_identifier id) const {
+    heightmap res{};
+    for (int z = 0; z < chunkWidth; z++)
+        for (int x = 0; x < chunkWidth; x++)
+            res[static_cast<std::size_t>(x + chunkWidth * z)] =
+                to_height(column_height(id.x * chunkWidth + x,
+                                        id.z * chunkWidth + z, seed));
+    return res;
+}
+
+TerrainGenerator::heightmap TerrainGenerator::heights(
+    chunk_identifier id) const {
+#if defined(__AVX2__) || defined(__SSE2__)
+    static_assert(chunkWidth % lanes == 0);
+    heightmap res{};
+    for (int z = 0; z < chunkWidth; z++)
+        for (int x = 0; x < chunkWidth; x += lanes)
+            heights_v(id.x * chunkWidth + x, id.z * chunkWidth + z, seed,
+                      &res[static_cast<std::size_t>(x + chunkWidth * z)]);
+    return res;
+#else
+    return heights_scalar(id);
+#endif
+}
+
+Chunk TerrainGenerator::generate(chunk_identifier id) const {
+    PROFILE_SCOPED();
+    const auto columns = heights(id);
+    const auto [min_height, max_height] =
+        std::minmax_element(columns.begin(), columns.end());
+
+    Chunk chunk{id};
+    for (int section = 0; section < chunkSectionCount; section++) {
+        const int bottom = section * chunkSectionHeight;
+        const int top = bottom + chunkSectionHeight - 1;
+        if (bottom > *max_height) break;  // the rest is air
+
+        if (top <= *min_height) {
+            chunk.fillSection(static_cast<std::size_t>(section),
+                              {BlockType::Grass});
+            continue;
+        }
+
+        for (int z = 0; z < chunkWidth; z++) {
+            for (int x = 0; x < chunkWidth; x++) {
+                const int height =
+                    columns[static_cast<std::size_t>(x + chunkWidth * z)];
+                for (int y = bottom; y <= std::min(top, height); y++)
+                    chunk.setBlock(x, y, z, {BlockType::Grass});
+            }
+        }
+    }
+    return chunk;
+}
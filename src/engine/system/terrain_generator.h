@@ -0,0 +1,35 @@
+#ifndef TERRAIN_GENERATOR_H_
+#define TERRAIN_GENERATOR_H_
+
+#include <array>
+#include <cstdint>
+
+#include "../component/chunk.h"
+
+// Seeded, deterministic terrain: the height of each column is a sum of
+// octaves of 2D value noise.
+//
+// The heights of all the columns of a chunk are computed in one batched pass,
+// vectorized with AVX2 or SSE2 when available. Every implementation gives
+// exactly the same heights as the scalar one.
+class TerrainGenerator {
+   public:
+    // Height of the highest block of each column, at x + chunkWidth * z
+    using heightmap = std::array<int, chunkWidth * chunkWidth>;
+
+    explicit TerrainGenerator(std::uint32_t seed) : seed(seed) {}
+
+    [[nodiscard]] Chunk generate(chunk_identifier id) const;
+
+    [[nodiscard]] heightmap heights(chunk_identifier id) const;
+    // Reference implementation
+    [[nodiscard]] heightmap heights_scalar(chunk_identifier id) const;
+
+    // Name of the implementation used by heights()
+    static const char* simd_name();
+
+   private:
+    std::uint32_t seed;
+};
+
+#endif  // !TERRAIN_GENERATOR_H_
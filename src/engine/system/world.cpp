@@ -10,6 +10,7 @@
 #include <iostream>
 #include <iterator>
 #include <optional>
+#include <utility>
 
 #include "../component/chunk.h"
 #include "../component/mesh.h"
@@ -17,84 +18,433 @@
 #include "../data/asset.h"
 #include "../data/block_texture.h"
 #include "../data/shader_layout.h"
+#include "../utils/frustum.h"
 #include "../utils/logging.h"
 #include "../utils/mat.h"
 #include "../utils/mat_opengl.h"
+#include "../utils/profiler.h"
 #include "camera_controller.h"
 
-typename World::chunk_data World::make_chunk_plus_context(int x, int z) const {
-    ChunkSimplifyerProxy chunk{{x, z}};
-    RendererContext renderer_context;
+typename World::chunk_data World::make_chunk_plus_context(int x, int z) {
+    chunk_identifier id{x, z};
+    chunk_data data{.id = id, .chunk = {}, .gpu_mesh = {}};
 
+    if (auto cached = recent_chunks.take(id)) {
+        data.edits = cached->edits;
+        if (cached->gpu_mesh) {
+            data.chunk.emplace(std::move(cached->chunk));
+            data.gpu_mesh = std::move(cached->gpu_mesh);
+        } else {
+            upload_chunk(data, std::move(cached->chunk));
+        }
+        arrived_chunks.push_back(id);
+        return data;
+    }
+
+    scheduler.request(id);
+    data.requested = true;
+    return data;
+}
+
+void World::evict_chunk(chunk_data&& data) {
+    if (!data.ready()) return;  // nothing worth keeping yet
+    if (data.modified) storage.save(data.chunk->getChunk());
+
+    std::size_t bytes = data.chunk->bytes();
+    if (cache_gpu_buffers) bytes += data.chunk->mesh.bytes();
+    else data.gpu_mesh = {};
+
+    recent_chunks.put(
+        data.id,
+        {std::move(*data.chunk), std::move(data.gpu_mesh), data.edits}, bytes);
+}
+
+bool World::is_in_window(chunk_identifier id) const {
+    const auto center = window_center.load(std::memory_order_relaxed);
+    const int half = static_cast<int>(window_half_size);
+    return std::abs(id.x - center.x) <= half &&
+           std::abs(id.z - center.z) <= half;
+}
+
+void World::build_chunk(chunk_identifier id,
+                        std::shared_ptr<const Chunk> blocks,
+                        const chunk_neighbours& neighbours,
+                        std::uint32_t edits) {
+    // The window may have moved since the job was dispatched
+    if (is_in_window(id)) {
+        // Loading or generation, then meshing, no GL calls here
+        if (!blocks) {
+            // Generated chunks are not saved, the seed generates them again
+            auto loaded = storage.load(id);
+            if (!loaded) loaded.emplace(generator.generate(id));
+            blocks = std::make_shared<const Chunk>(std::move(*loaded));
+        }
+
+        ChunkSimplifyerProxy chunk{std::move(blocks), meshing_mode.load(),
+                                   neighbours};
+        if (is_in_window(id)) ready_chunks.push({std::move(chunk), edits});
+        else jobs_cancelled++;
+    } else {
+        jobs_cancelled++;
+    }
+    jobs_in_flight--;
+}
+
+void World::dispatch_chunk_jobs() {
+    scheduler.update(player_controller->player.self.position,
+                     camera_controller->get_view_direction(),
+                     [this](chunk_identifier id) {
+                         auto* data = world.find(id);
+                         if (data == nullptr) return false;
+                         if (data->ready() && is_mesh_current(*data)) {
+                             data->requested = false;
+                             return false;
+                         }
+                         return true;
+                     });
+
+    while (jobs_in_flight < workers.size()) {
+        auto id = scheduler.pop();
+        if (!id) break;
+
+        const auto* data = world.find(*id);
+        if (data == nullptr) continue;
+
+        // Remeshing reuses the blocks
+        std::shared_ptr<const Chunk> blocks;
+        if (data->chunk) blocks = data->chunk->getSharedChunk();
+
+        jobs_in_flight++;
+        workers.submit([this, id = *id, blocks = std::move(blocks),
+                        neighbours = get_neighbours(*id), edits = data->edits] {
+            build_chunk(id, blocks, neighbours, edits);
+        });
+    }
+}
+
+void World::upload_chunk(chunk_data& data, ChunkSimplifyerProxy&& chunk) {
     const auto& mesh = chunk.mesh;
-    const auto ctx = renderer_context.use();
 
-    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(mesh.bytes()),
-                 mesh.data(), GL_STATIC_DRAW);
+    // A rebuilt mesh takes the place of the old one when it fits
+    if (data.gpu_mesh) arena->update(data.gpu_mesh, mesh.data(), mesh.size());
+    else data.gpu_mesh = arena->upload(mesh.data(), mesh.size());
 
-    auto with_shader = shader->use();
-    shader->useLayout(decltype(chunk)::mesh_type::layout);
+    data.chunk.emplace(std::move(chunk));
+}
 
-    atlas->bind();
+void World::upload_ready_chunks() {
+    PROFILE_SCOPED();
+    std::size_t uploaded = 0;
+    while (uploaded < chunk_uploads_per_frame) {
+        auto built = ready_chunks.try_pop();
+        if (!built) break;
 
-    return {std::move(chunk), renderer_context};
+        // The chunk may have gone out of range, or may have been built twice
+        // if the player went back and forth
+        const auto id = built->chunk.getId();
+        auto* data = world.find(id);
+        if (data == nullptr) continue;
+        data->requested = false;
+        if (data->ready() && is_mesh_current(*data)) continue;
+
+        // Built from blocks that have been edited since
+        if (data->ready() && built->edits != data->edits) {
+            request_chunk(*data);
+            continue;
+        }
+
+        // A mesh built before a change of meshing mode or before the arrival
+        // of a neighbour is still better than nothing, and is rebuilt
+        const bool arrived = !data->ready();
+        upload_chunk(*data, std::move(built->chunk));
+        if (arrived) on_chunk_arrived(id);
+        if (!is_mesh_current(*data)) request_chunk(*data);
+        uploaded++;
+    }
 }
 
-const std::size_t max_size = 30000 * sizeof(BlockVertex);
-World::World(const CameraController* camera_controller,
-             const PlayerController* player_controller)
-    : camera_controller(camera_controller),
+const std::size_t max_size =
+    30000 * sizeof(ChunkSimplifyerProxy::mesh_type::vertex_type);
+World::World(RenderDevice& device, const CameraController* camera_controller,
+             const PlayerController* player_controller,
+             const std::filesystem::path& world_directory,
+             const std::filesystem::path& baked_directory)
+    : device(device),
+      storage(world_directory),
+      camera_controller(camera_controller),
       player_controller(player_controller) {
-    shader.emplace(get_asset<AssetKind::Shader>("base"));
-    atlas.emplace(get_asset<AssetKind::TextureAtlas>("minecraft.png", 16, 16));
+    shader.emplace(get_asset<AssetKind::Shader>(device, "base"));
+    atlas.emplace(get_asset<AssetKind::TextureAtlas>(device, "minecraft.png",
+                                                     16, 16, baked_directory));
 
+    {
+        auto with_shader = shader->use();
+        device.uniform1i(
+            shader->getUniformLocation("packed_vertex"),
+            ChunkSimplifyerProxy::mesh_type::vertex_type::is_packed);
+    }
+    camera_uniforms.emplace(device, camera_binding);
+    arena.emplace(device, *shader,
+                  Layout{ChunkSimplifyerProxy::mesh_type::layout},
+                  sizeof(ChunkSimplifyerProxy::mesh_type::vertex_type));
+
+    world.set_evict_callback(std::bind_front(&World::evict_chunk, this));
     world.set_factory(std::bind_front(&World::make_chunk_plus_context, this));
-    glEnable(GL_FRAMEBUFFER_SRGB);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
+    device.enable(GL_FRAMEBUFFER_SRGB);
+    device.enable(GL_DEPTH_TEST);
+    device.enable(GL_CULL_FACE);
+}
+
+World::~World() {
+    for (const auto& data : world) {
+        if (data.edited) storage.save(*data.edited);
+        else if (data.modified) storage.save(data.chunk->getChunk());
+    }
+
+    log << LogLevel::Info << "Chunk jobs cancelled: "
+        << scheduler.cancelled_count() << " before dispatch, "
+        << jobs_cancelled.load() << " on workers";
+    log << LogLevel::Info << "Recent chunks cache: " << cache_hits()
+        << " hits, " << cache_misses() << " misses, "
+        << recent_chunks.eviction_count() << " evictions";
+
+    // Unblocks the workers waiting for some room in the queue
+    ready_chunks.close();
 }
 
 chunk_identifier get_chunk_id(const math::vec3f& pos) {
-    return {.x = static_cast<int>(pos[0] / chunkWidth),
-            .z = static_cast<int>(pos[2] / chunkWidth)};
+    return {.x = static_cast<int>(std::floor(pos[0] / chunkWidth)),
+            .z = static_cast<int>(std::floor(pos[2] / chunkWidth))};
+}
+
+bool World::is_mesh_current(const chunk_data& data) const {
+    if (!data.ready() || data.chunk->getMeshingMode() != meshing_mode)
+        return false;
+
+    for (std::size_t i = 0; i < neighbourOffsets.size(); i++) {
+        const auto* neighbour =
+            world.find({data.id.x + neighbourOffsets[i].x,
+                        data.id.z + neighbourOffsets[i].z});
+        if (neighbour != nullptr && neighbour->chunk &&
+            !data.chunk->hasNeighbour(i))
+            return false;
+    }
+    return true;
+}
+
+void World::request_chunk(chunk_data& data) {
+    if (data.requested) return;
+    scheduler.request(data.id);
+    data.requested = true;
+}
+
+chunk_neighbours World::get_neighbours(chunk_identifier id) const {
+    chunk_neighbours neighbours;
+    for (std::size_t i = 0; i < neighbourOffsets.size(); i++) {
+        const auto* neighbour = world.find(
+            {id.x + neighbourOffsets[i].x, id.z + neighbourOffsets[i].z});
+        if (neighbour == nullptr) continue;
+        if (neighbour->edited) neighbours[i] = neighbour->edited;
+        else if (neighbour->chunk)
+            neighbours[i] = neighbour->chunk->getSharedChunk();
+    }
+    return neighbours;
+}
+
+void World::on_chunk_arrived(chunk_identifier id) {
+    for (std::size_t i = 0; i < neighbourOffsets.size(); i++) {
+        auto* neighbour = world.find(
+            {id.x + neighbourOffsets[i].x, id.z + neighbourOffsets[i].z});
+        if (neighbour != nullptr && neighbour->ready() &&
+            !neighbour->chunk->hasNeighbour(oppositeNeighbour(i)))
+            request_chunk(*neighbour);
+    }
+}
+
+bool World::set_block(int x, int y, int z, BlockData block) {
+    if (y < 0 || y >= chunkHeight) return false;
+
+    const chunk_identifier id{floor_div(x, chunkWidth),
+                              floor_div(z, chunkWidth)};
+    auto* data = world.find(id);
+    if (data == nullptr || !data->ready()) return false;
+
+    const int local_x = x - id.x * chunkWidth;
+    const int local_z = z - id.z * chunkWidth;
+    auto mark_dirty = [this](chunk_data& dirty, section_mask sections) {
+        if (sections == 0) return;
+        if (dirty.dirty_sections == 0) dirty_chunks.push_back(dirty.id);
+        dirty.dirty_sections |= sections;
+    };
+
+    // Copy on write: the blocks may be read by the workers
+    if (!data->edited)
+        data->edited = std::make_shared<Chunk>(data->chunk->getChunk());
+    mark_dirty(*data, data->edited->setBlock(local_x, y, local_z, block));
+    data->modified = true;
+
+    for (std::size_t i = 0; i < neighbourOffsets.size(); i++) {
+        auto* neighbour = world.find(
+            {id.x + neighbourOffsets[i].x, id.z + neighbourOffsets[i].z});
+        if (neighbour != nullptr)
+            mark_dirty(*neighbour, borderSections(i, local_x, y, local_z));
+    }
+    return true;
+}
+
+void World::remesh_dirty_chunks() {
+    PROFILE_SCOPED();
+    std::vector<chunk_identifier> not_ready;
+    for (auto id : dirty_chunks) {
+        auto* data = world.find(id);
+        if (data == nullptr || data->dirty_sections == 0) continue;
+        // Remeshed once it is there
+        if (!data->ready()) {
+            not_ready.push_back(id);
+            continue;
+        }
+
+        if (data->edited) data->edited->compactSections(data->dirty_sections);
+        auto blocks = data->edited ? std::shared_ptr<const Chunk>(
+                                         std::move(data->edited))
+                                   : data->chunk->getSharedChunk();
+        data->edited.reset();
+        const auto first = data->chunk->remeshSections(
+            std::move(blocks), data->dirty_sections, get_neighbours(id));
+        data->dirty_sections = 0;
+        data->edits++;
+
+        const auto& mesh = data->chunk->mesh;
+        arena->update(data->gpu_mesh, mesh.data(), mesh.size(), first);
+    }
+    dirty_chunks = std::move(not_ready);
+}
+
+void World::set_meshing_mode(MeshingMode mode) {
+    if (mode == meshing_mode) return;
+    meshing_mode = mode;
+
+    // Chunks not ready yet will be built with the new mode
+    recent_chunks.clear();
+    for (auto& data : world)
+        if (data.ready()) request_chunk(data);
+}
+
+std::size_t World::vertex_count() const {
+    std::size_t count = 0;
+    for (const auto& data : world)
+        if (data.ready()) count += data.chunk->mesh.size();
+    return count;
+}
+
+std::size_t World::ready_chunk_count() const {
+    std::size_t count = 0;
+    for (const auto& data : world)
+        if (data.ready()) count++;
+    return count;
+}
+
+std::optional<int> World::surface_height(float x, float z) const {
+    const auto* data = world.find(get_chunk_id({x, 0, z}));
+    if (data == nullptr || !data->chunk) return {};
+
+    const auto local = [](float coord) {
+        return static_cast<std::size_t>(positive_modulo(
+            static_cast<int>(std::floor(coord)), chunkWidth));
+    };
+    const int height = data->chunk->getChunk().getHeight(local(x), local(z));
+    if (height < 0) return {};
+    return height;
 }
 
 void World::update(float /*dt*/) {
+    // Edits made since the last frame are displayed by this one
+    remesh_dirty_chunks();
+
     chunk_identifier player_chunk_id =
         get_chunk_id(player_controller->player.self.position);
 
     world.set_current_position(player_chunk_id.x, player_chunk_id.z);
-}
+    window_center = player_chunk_id;
 
-void renderMeshChunk(const CameraController* camera_controller, Shader& shader,
-                     const ChunkSimplifyerProxy& chunk,
-                     const RendererContext& renderer_context) {
-    const auto& mesh = chunk.mesh;
-    auto ctx = renderer_context.use();
-    // atlas->bind();
+    for (auto id : arrived_chunks) {
+        auto* data = world.find(id);
+        if (data == nullptr) continue;
+        on_chunk_arrived(id);
+        if (!is_mesh_current(*data)) request_chunk(*data);
+    }
+    arrived_chunks.clear();
 
-    auto with_shader = shader.use();
+    dispatch_chunk_jobs();
+    upload_ready_chunks();
+}
 
-    auto model_trans = mesh.getModelMatrix();
-    auto [chunk_x, chunk_z] = chunk.getId();
-    auto world_trans =
-        math::translation<float>(static_cast<float>(chunkWidth * chunk_x), 0,
-                                 static_cast<float>(chunkWidth * chunk_z));
-    auto proj = camera_controller->getCameraMatrix();
+section_mask World::frustum_sections(const math::frustum& frustum,
+                                     chunk_identifier id) {
+    const math::vec3f origin{static_cast<float>(id.x * chunkWidth), 0,
+                             static_cast<float>(id.z * chunkWidth)};
+    const math::aabb bounds{
+        origin, origin + math::vec3f{chunkWidth, chunkHeight, chunkWidth}};
+    if (!math::intersects(frustum, bounds)) return 0;
+    return (section_mask{1} << chunkSectionCount) - 1;
+}
 
-    GLint modelUnif = shader.getUniformLocation("model");
-    GLint worldUnif = shader.getUniformLocation("world");
-    GLint projUnif = shader.getUniformLocation("proj");
-    glUniformMatrix4fv(modelUnif, 1, GL_TRUE, model_trans.ptr());
-    glUniformMatrix4fv(worldUnif, 1, GL_TRUE, world_trans.ptr());
-    glUniformMatrix4fv(projUnif, 1, GL_TRUE, proj.ptr());
+void World::add_chunk_draws(const chunk_data& data, section_mask sections) {
+    const mesh_origin origin{data.id.x * chunkWidth, data.id.z * chunkWidth};
+    // One draw per run of consecutive sections, their quads are contiguous
+    for (std::size_t first = 0; first < chunkSectionCount; first++) {
+        if ((sections >> first & 1U) == 0) continue;
+        std::size_t last = first + 1;
+        while (last < chunkSectionCount && (sections >> last & 1U) != 0)
+            last++;
 
-    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(mesh.size()));
+        const auto [first_quad, last_quad] =
+            data.chunk->getSectionQuads(first, last);
+        draws.add((last_quad - first_quad) * indicesPerQuad,
+                  data.gpu_mesh.offset() + first_quad * verticesPerQuad,
+                  origin);
+        first = last;
+    }
 }
 
 void World::render() {
-    for (auto& [chunk, renderer_context] : world) {
-        assert(chunk.mesh.bytes() < max_size);
-        renderMeshChunk(camera_controller, *shader, chunk, renderer_context);
+    PROFILE_SCOPED();
+    const auto proj = camera_controller->getCameraMatrix();
+    const auto frustum = math::extractFrustum(proj);
+
+    if (occlusion_culling) {
+        culler.update(
+            camera_controller->get_position(),
+            static_cast<int>(world.size() / 2),
+            [this](chunk_identifier id) -> const chunk_visibility* {
+                const auto* data = world.find(id);
+                if (data == nullptr || !data->ready()) return nullptr;
+                return &data->chunk->getVisibility();
+            },
+            &frustum);
+    }
+
+    draws.clear();
+    last_drawn = 0;
+    last_culled = 0;
+    for (const auto& data : world) {
+        if (!data.ready()) continue;  // still being built
+
+        assert(data.chunk->mesh.bytes() < max_size);
+        const section_mask sections = occlusion_culling
+                                          ? culler.visibleSections(data.id)
+                                          : frustum_sections(frustum, data.id);
+        if (sections == 0) {
+            last_culled++;
+            continue;
+        }
+        add_chunk_draws(data, sections);
+        last_drawn++;
     }
+
+    camera_uniforms->update({proj, chunk_model});
+
+    auto with_shader = shader->use();
+    atlas->bind();
+    arena->draw(draws);
 }
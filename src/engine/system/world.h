@@ -3,33 +3,231 @@
 
 #include <glad/glad.h>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
 #include <optional>
+#include <vector>
 
 #include "../component/chunk.h"
-#include "../component/renderer_context.h"
+#include "../component/mesh_arena.h"
+#include "../component/render_device.h"
 #include "../component/shader.h"
 #include "../component/texture_atlas.h"
+#include "../component/uniform_buffer.h"
+#include "../data/region_storage.h"
+#include "../data_structure/bounded_queue.h"
+#include "../data_structure/lru_cache.h"
+#include "../utils/frustum.h"
+#include "../utils/thread_pool.h"
 #include "camera_controller.h"
+#include "chunk_load_scheduler.h"
+#include "occlusion_culler.h"
 #include "player_controller.h"
+#include "terrain_generator.h"
 
 class World {
    public:
-    World(const CameraController* camera_controller,
-          const PlayerController* player_controller);
+    // Chunks are saved to and loaded from world_directory, the assets are
+    // baked into baked_directory
+    World(RenderDevice& device, const CameraController* camera_controller,
+          const PlayerController* player_controller,
+          const std::filesystem::path& world_directory = "./world",
+          const std::filesystem::path& baked_directory = "./cache/asset");
     World(World&) = delete;
     World(World&&) = delete;
+    ~World();
     void render();
     void update(float dt);
 
+    [[nodiscard]] std::size_t cache_hits() const {
+        return recent_chunks.hit_count();
+    }
+    [[nodiscard]] std::size_t cache_misses() const {
+        return recent_chunks.miss_count();
+    }
+    [[nodiscard]] std::size_t cache_bytes() const {
+        return recent_chunks.bytes();
+    }
+
+    // Remeshes every chunk in the window in the background, the old meshes
+    // are displayed until the new ones are uploaded
+    void set_meshing_mode(MeshingMode mode);
+    [[nodiscard]] MeshingMode get_meshing_mode() const {
+        return meshing_mode.load();
+    }
+    // Vertices of all the meshes that are displayed
+    [[nodiscard]] std::size_t vertex_count() const;
+    // Chunks of the window whose mesh is uploaded, out of all of them
+    [[nodiscard]] std::size_t ready_chunk_count() const;
+    [[nodiscard]] std::size_t window_chunk_count() const {
+        return static_cast<std::size_t>(world.size()) * world.size();
+    }
+    // Vertices allocated to the resident and cached meshes, out of the size
+    // of the shared vertex buffer
+    [[nodiscard]] std::size_t arena_used() const { return arena->used(); }
+    [[nodiscard]] std::size_t arena_capacity() const {
+        return arena->capacity();
+    }
+    // Chunks drawn by the last render, and the ones outside of the view or
+    // hidden
+    [[nodiscard]] std::size_t drawn_chunks() const { return last_drawn; }
+    [[nodiscard]] std::size_t culled_chunks() const { return last_culled; }
+    [[nodiscard]] std::size_t draw_count() const { return draws.size(); }
+
+    // Only draws the sections that can be seen through the air of the
+    // sections in front of them, see OcclusionCuller. Otherwise, every chunk
+    // in the frustum is drawn
+    void set_occlusion_culling(bool enabled) { occlusion_culling = enabled; }
+    [[nodiscard]] bool get_occlusion_culling() const {
+        return occlusion_culling;
+    }
+
+    // Height of the highest block at world position x z, for spawning and
+    // collisions. Nothing if the chunk is not loaded yet or the column is
+    // empty
+    [[nodiscard]] std::optional<int> surface_height(float x, float z) const;
+
+    // Changes the block at world position x y z. The chunk and the neighbours
+    // it touches only remesh the dirty sections at the next update, before
+    // the next render. False if the chunk is not displayed yet
+    bool set_block(int x, int y, int z, BlockData block);
+
    private:
-    using chunk_data = std::pair<ChunkSimplifyerProxy, RendererContext>;
-    [[nodiscard]] chunk_data make_chunk_plus_context(int x, int z) const;
+    // A resident chunk. chunk and gpu_mesh are empty until the chunk has been
+    // generated and meshed by a worker, then uploaded
+    struct chunk_data {
+        chunk_identifier id;
+        std::optional<ChunkSimplifyerProxy> chunk;
+        MeshArena::Allocation gpu_mesh;
+        // Waiting in the scheduler or on a worker
+        bool requested = false;
+        // Edited copy of the blocks, until the next update
+        std::shared_ptr<Chunk> edited{};
+        // Sections to remesh at the next update
+        section_mask dirty_sections = 0;
+        // Remeshes done on the main thread, the meshes built by the workers
+        // before the last of them are outdated
+        std::uint32_t edits = 0;
+        // Edited since it was loaded, saved when it leaves the window
+        bool modified = false;
+
+        [[nodiscard]] bool ready() const {
+            return static_cast<bool>(gpu_mesh);
+        }
+    };
+
+    // Built with the current meshing mode and all the neighbours that are
+    // loaded, so without hidden faces on its borders
+    [[nodiscard]] bool is_mesh_current(const chunk_data& data) const;
+    // Schedules the build, or the remesh if the blocks are already there
+    void request_chunk(chunk_data& data);
+    // Blocks of the loaded neighbours of id
+    [[nodiscard]] chunk_neighbours get_neighbours(chunk_identifier id) const;
+    // The neighbours meshed before the blocks of id were there are remeshed
+    void on_chunk_arrived(chunk_identifier id);
+    // Remeshes the dirty sections of the edited chunks and uploads the part
+    // of their vertex buffers that changed
+    void remesh_dirty_chunks();
+
+    // Takes the chunk from the cache of recent chunks, or requests its
+    // generation to the scheduler
+    [[nodiscard]] chunk_data make_chunk_plus_context(int x, int z);
+    // Keeps the chunks getting out of the window in recent_chunks
+    void evict_chunk(chunk_data&& data);
+    // Gives the most urgent chunks to the workers, keeping at most one chunk
+    // in flight per worker so that priorities stay fresh
+    void dispatch_chunk_jobs();
+    // Loads or generates the blocks if they are not given, then meshes them
+    void build_chunk(chunk_identifier id, std::shared_ptr<const Chunk> blocks,
+                     const chunk_neighbours& neighbours, std::uint32_t edits);
+    // Thread safe: can be called by workers
+    [[nodiscard]] bool is_in_window(chunk_identifier id) const;
+    // All the sections if the chunk is in the frustum, none otherwise
+    static section_mask frustum_sections(const math::frustum& frustum,
+                                         chunk_identifier id);
+    // The draws of the sections of a ready chunk
+    void add_chunk_draws(const chunk_data& data, section_mask sections);
+    // Moves the chunks built by the workers into the world and uploads their
+    // mesh, at most chunk_uploads_per_frame of them
+    void upload_ready_chunks();
+    void upload_chunk(chunk_data& data, ChunkSimplifyerProxy&& chunk);
 
-    chunk_array<chunk_data> world;
+    // Chunks that recently got out of the window, with their GPU buffers if
+    // cache_gpu_buffers is set. Going back and forth across a chunk border
+    // then neither regenerates nor remeshes anything
+    struct cached_chunk {
+        ChunkSimplifyerProxy chunk;
+        MeshArena::Allocation gpu_mesh;
+        // Jobs still in flight for the chunk may come back
+        std::uint32_t edits;
+    };
+    static const bool cache_gpu_buffers = true;
+    RenderDevice& device;
+    // The meshes of the resident and cached chunks live in arena, it has to
+    // be destroyed after them
+    std::optional<Shader> shader;
+    std::optional<MeshArena> arena;
+    // Rebuilt every frame, kept for its memory
+    mesh_draw_list draws;
+    std::size_t last_drawn = 0;
+    std::size_t last_culled = 0;
+    bool occlusion_culling = true;
+    OcclusionCuller culler;
+    static const std::size_t recent_chunks_capacity = 64 * 1024 * 1024;
+    lru_cache<chunk_identifier, cached_chunk, chunk_identifier_hash>
+        recent_chunks{recent_chunks_capacity};
+
+    static const std::size_t chunk_uploads_per_frame = 8;
+    static const std::size_t ready_chunks_capacity = 64;
+
+    // A chunk built by a worker, with the edits count of the chunk when the
+    // job was dispatched
+    struct built_chunk {
+        ChunkSimplifyerProxy chunk;
+        std::uint32_t edits;
+    };
+
+    // Order matters: the workers use everything declared before them, so they
+    // have to be stopped first
+    bounded_queue<built_chunk> ready_chunks{ready_chunks_capacity};
+    // Chunks are loaded from there before being generated
+    RegionStorage storage;
+    static const std::uint32_t world_seed = 0x6d696e65;
+    const TerrainGenerator generator{world_seed};
+    // Center and half size of the window, published for the workers
+    std::atomic<chunk_identifier> window_center{};
+    const unsigned int window_half_size = default_half_size;
+    std::atomic<std::size_t> jobs_in_flight = 0;
+    std::atomic<std::size_t> jobs_cancelled = 0;
+    std::atomic<MeshingMode> meshing_mode = MeshingMode::PerFace;
+    ThreadPool workers;
+
+    ChunkLoadScheduler scheduler{chunkWidth};
+
+    chunk_array<chunk_data> world{window_half_size};
+    // Chunks taken from recent_chunks while moving the window, their
+    // neighbours are updated once the move is done
+    std::vector<chunk_identifier> arrived_chunks;
+    // Chunks with dirty sections
+    std::vector<chunk_identifier> dirty_chunks;
     const CameraController* camera_controller;
     const PlayerController* player_controller;
-    std::optional<Shader> shader;
     std::optional<TextureAtlas> atlas;
+
+    // The Camera block of asset/shader/base.vert, row major
+    struct camera_block {
+        math::mat4f proj;
+        math::mat4f model;
+    };
+    // Chunk meshes are placed by their origin, their model matrix is the
+    // identity
+    static constexpr math::mat4f chunk_model = math::identity<float, 4>();
+    static constexpr GLuint camera_binding = 0;
+    std::optional<UniformBuffer<camera_block>> camera_uniforms;
+    Logger log{Logger::get({"World"})};
 };
 
 #endif  // !WORLD_H_
@@ -0,0 +1,50 @@
+#ifndef FRUSTUM_H_
+#define FRUSTUM_H_
+
+#include <array>
+
+#include "mat.h"
+
+namespace math {
+
+// Axis aligned box, min and max corners included
+struct aabb {
+    vec3f min;
+    vec3f max;
+};
+
+// The six planes bounding what a projection matrix displays, as (a, b, c, d)
+// with a x + b y + c z + d >= 0 inside. Not normalized: only the sign of the
+// distance is used
+struct frustum {
+    std::array<vec4f, 6> planes;
+};
+
+// Planes of the clip volume -w <= x, y, z <= w of proj_view, in the space the
+// matrix is applied to (Gribb and Hartmann)
+constexpr frustum extractFrustum(const mat4f& proj_view) {
+    const auto& w = proj_view[3];
+    frustum res{};
+    for (int axis = 0; axis < 3; axis++) {
+        res.planes[2 * axis] = w + proj_view[axis];
+        res.planes[2 * axis + 1] = w - proj_view[axis];
+    }
+    return res;
+}
+
+// False only if the box is entirely outside one of the planes. Boxes near the
+// corners of the frustum may be kept although they are outside, never the
+// other way around
+constexpr bool intersects(const frustum& frustum, const aabb& box) {
+    for (const auto& plane : frustum.planes) {
+        // Corner of the box the furthest inside the plane
+        float distance = plane[3];
+        for (int i = 0; i < 3; i++)
+            distance += plane[i] * (plane[i] >= 0 ? box.max[i] : box.min[i]);
+        if (distance < 0) return false;
+    }
+    return true;
+}
+
+};      // namespace math
+#endif  // !FRUSTUM_H_
@@ -1,5 +1,13 @@
 #include "logging.h"
 
+#include <mutex>
+
+namespace {
+// Loggers are also created from worker threads, category_known must not be
+// modified concurrently. Recursive because get() logs new categories.
+std::recursive_mutex category_mutex;
+}  // namespace
+
 LogLevel Logger::global_log_level = LogLevel::Info;
 std::unordered_set<std::string> Logger::category_whitelist{};
 std::unordered_set<std::string> Logger::category_known{};
@@ -9,6 +17,7 @@ Logger Logger::get(LoggerOptions opts, std::source_location location) {
     std::ostringstream ss;
     if (!opts.location.has_value()) opts.location = location;
 
+    std::scoped_lock lock{category_mutex};
     if (!category_known.contains(opts.category)) {
         // Order is important to prevent infinite recursion !
         category_known.insert(opts.category);
@@ -23,6 +23,12 @@
 class ProfileFunction {
    public:
     ~ProfileFunction() {
+        // Checked at the end of the scope rather than at its beginning, so a
+        // scope opened before the whitelist is set (main) still reports.
+        // Getting a logger allocates, which is too much for the hot paths
+        // when nobody looks at the timings
+        if (!Logger::category_whitelist.contains("Profiler")) return;
+
         auto end = std::chrono::high_resolution_clock::now();
         std::chrono::duration<float, std::micro> delta_us = end - begin;
 
@@ -37,6 +43,9 @@ class ProfileFunction {
             suffix = "s";
         }
 
+        auto logger = Logger::get({.category = "Profiler",
+                                   .level = LogLevel::Trace,
+                                   .location = location});
         auto s = logger.get_stream();
         s << std::fixed << std::setprecision(2) << count << suffix;
         if (show_fps) {
@@ -50,21 +59,18 @@ class ProfileFunction {
     static ProfileFunction make_profiler_scope(
         bool show_fps = false,
         const std::source_location location = std::source_location::current()) {
-        return {Logger::get({.category = "Profiler",
-                             .level = LogLevel::Trace,
-                             .location = location}),
-                show_fps};
+        return {show_fps, location};
     }
 
    private:
-    ProfileFunction(Logger l, bool show_fps)
+    ProfileFunction(bool show_fps, std::source_location location)
         : begin(std::chrono::high_resolution_clock::now()),
           show_fps(show_fps),
-          logger(std::move(l)) {}
+          location(location) {}
 
     const std::chrono::high_resolution_clock::time_point begin;
     bool show_fps;
-    Logger logger;
+    std::source_location location;
 };
 
 #endif  // !PROFILER_H_
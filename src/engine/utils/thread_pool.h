@@ -0,0 +1,72 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Fixed number of workers executing tasks in submission order.
+// Tasks still waiting when the pool is destroyed are dropped.
+class ThreadPool {
+   public:
+    using task_type = std::function<void()>;
+
+    explicit ThreadPool(std::size_t worker_count = default_worker_count()) {
+        workers.reserve(worker_count);
+        for (std::size_t i = 0; i < worker_count; i++)
+            workers.emplace_back([this](std::stop_token stop) { work(stop); });
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        for (auto& worker : workers) worker.request_stop();
+        task_available.notify_all();
+        // jthreads are joined on destruction
+    }
+
+    void submit(task_type task) {
+        {
+            std::scoped_lock lock{mutex};
+            tasks.push_back(std::move(task));
+        }
+        task_available.notify_one();
+    }
+
+    [[nodiscard]] std::size_t size() const { return workers.size(); }
+
+    // Keep one core for the render thread
+    static std::size_t default_worker_count() {
+        const std::size_t cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 1;
+    }
+
+   private:
+    void work(const std::stop_token& stop) {
+        while (true) {
+            task_type task;
+            {
+                std::unique_lock lock{mutex};
+                task_available.wait(lock, stop, [&] { return !tasks.empty(); });
+                if (stop.stop_requested()) return;
+
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable_any task_available;
+    std::deque<task_type> tasks;
+    std::vector<std::jthread> workers;
+};
+
+#endif  // !THREAD_POOL_H_
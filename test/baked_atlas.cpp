@@ -0,0 +1,146 @@
+#include <engine/data/baked_atlas.h>
+
+#include <array>
+#include <bit>
+#include <cstdlib>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "temporary_directory.h"
+
+namespace {
+// width x height texels, red is x, green is y
+std::vector<std::uint8_t> gradient(std::size_t width, std::size_t height) {
+    std::vector<std::uint8_t> rgba;
+    for (std::size_t y = 0; y < height; y++) {
+        for (std::size_t x = 0; x < width; x++) {
+            rgba.push_back(static_cast<std::uint8_t>(x));
+            rgba.push_back(static_cast<std::uint8_t>(y));
+            rgba.push_back(0);
+            rgba.push_back(255);
+        }
+    }
+    return rgba;
+}
+
+std::array<std::uint8_t, 4> texel(const baked_atlas& atlas, std::size_t level,
+                                  std::size_t layer, std::size_t x,
+                                  std::size_t y) {
+    const std::size_t width = mip_size(atlas.width, level);
+    const std::size_t height = mip_size(atlas.height, level);
+    const auto* t =
+        &atlas.levels[level][((layer * height + y) * width + x) * 4];
+    return {t[0], t[1], t[2], t[3]};
+}
+
+// Each channel within one of expected: averages of halves may round either way
+// once the colors go through linear space
+bool near(std::array<std::uint8_t, 4> actual,
+          std::array<std::uint8_t, 4> expected) {
+    for (std::size_t c = 0; c < 4; c++)
+        if (std::abs(int{actual[c]} - int{expected[c]}) > 1) return false;
+    return true;
+}
+}  // namespace
+
+TEST_CASE("bake_atlas cuts the tiles in layers") {
+    // 3 x 2 tiles of 4 x 2 texels
+    const auto image = gradient(12, 4);
+    const auto atlas = bake_atlas(image.data(), 12, 4, 3, 2);
+    REQUIRE(atlas.width == 4);
+    REQUIRE(atlas.height == 2);
+    REQUIRE(atlas.layers() == 6);
+    REQUIRE(atlas.levels[0].size() == 6 * 4 * 2 * 4);
+
+    for (std::size_t row = 0; row < 2; row++)
+        for (std::size_t column = 0; column < 3; column++)
+            for (std::size_t y = 0; y < 2; y++)
+                for (std::size_t x = 0; x < 4; x++) {
+                    const auto t = texel(atlas, 0, 3 * row + column, x, y);
+                    REQUIRE(t[0] == 4 * column + x);
+                    REQUIRE(t[1] == 2 * row + y);
+                }
+
+    REQUIRE_THROWS_AS(bake_atlas(image.data(), 12, 4, 5, 2),
+                      std::runtime_error);
+}
+
+TEST_CASE("bake_atlas builds the mipmaps down to 1x1") {
+    const auto image = gradient(8, 4);
+    const auto atlas = bake_atlas(image.data(), 8, 4, 2, 1);
+    // 4x4, 2x2, 1x1
+    REQUIRE(atlas.levels.size() == 3);
+    REQUIRE(atlas.levels[1].size() == 2 * 2 * 2 * 4);
+    REQUIRE(atlas.levels[2].size() == 2 * 1 * 1 * 4);
+
+    // Texels 0 and 1 of layer 0
+    using rgba = std::array<std::uint8_t, 4>;
+    REQUIRE(near(texel(atlas, 1, 0, 0, 0), rgba{1, 1, 0, 255}));
+    // Texels 6 and 7 of layer 1, rows 2 and 3
+    REQUIRE(near(texel(atlas, 1, 1, 1, 1), rgba{7, 3, 0, 255}));
+    REQUIRE(near(texel(atlas, 2, 1, 0, 0), rgba{6, 2, 0, 255}));
+
+    // Odd sizes clamp the texels out of the level
+    const auto odd = bake_atlas(gradient(3, 1).data(), 3, 1, 1, 1);
+    REQUIRE(odd.levels.size() == 2);
+    REQUIRE(near(texel(odd, 1, 0, 0, 0), rgba{1, 0, 0, 255}));
+}
+
+TEST_CASE("bake_atlas averages the colors in linear space") {
+    // A transparent black texel and an opaque white one
+    const std::vector<std::uint8_t> image{0, 0, 0, 0, 255, 255, 255, 255};
+    const auto atlas = bake_atlas(image.data(), 2, 1, 1, 1);
+    REQUIRE(atlas.levels.size() == 2);
+
+    // Half the light of white is 188 in sRGB, not 128. Alpha is linear
+    using rgba = std::array<std::uint8_t, 4>;
+    REQUIRE(texel(atlas, 1, 0, 0, 0) == rgba{188, 188, 188, 128});
+}
+
+TEST_CASE("BakedAtlasFile save and map") {
+    temporary_directory dir;
+    const auto path = dir.path / "atlas.atlas";
+    const auto image = gradient(8, 4);
+    const auto atlas = bake_atlas(image.data(), 8, 4, 2, 1);
+    BakedAtlasFile::save(path, atlas);
+
+    {
+        const BakedAtlasFile file{path};
+        REQUIRE(file.width() == 4);
+        REQUIRE(file.height() == 4);
+        REQUIRE(file.layers() == 2);
+        REQUIRE(file.level_count() == atlas.levels.size());
+        for (std::size_t i = 0; i < file.level_count(); i++) {
+            REQUIRE(file.level_size(i) == atlas.levels[i].size());
+            REQUIRE(std::vector<std::uint8_t>(
+                        file.level(i), file.level(i) + file.level_size(i)) ==
+                    atlas.levels[i]);
+        }
+    }
+
+    fs::resize_file(path, fs::file_size(path) - 1);
+    REQUIRE_THROWS_AS(BakedAtlasFile{path}, std::runtime_error);
+}
+
+TEST_CASE("BakedAtlasFile bakes the atlas once") {
+    temporary_directory dir;
+    const fs::path image = "./asset/texture/minecraft.png";
+    const auto path = dir.path / "minecraft.png.atlas";
+
+    BakedAtlasFile::bake_if_outdated(image, path, 16, 16);
+    const auto baked_time = fs::last_write_time(path);
+    {
+        const BakedAtlasFile file{path};
+        REQUIRE(file.layers() == 256);
+        REQUIRE(file.level_count() == 1 + std::bit_width(file.width() - 1));
+    }
+
+    BakedAtlasFile::bake_if_outdated(image, path, 16, 16);
+    REQUIRE(fs::last_write_time(path) == baked_time);
+
+    // Another tiling is baked again
+    BakedAtlasFile::bake_if_outdated(image, path, 8, 16);
+    REQUIRE(BakedAtlasFile{path}.horizontal_tiles() == 8);
+}
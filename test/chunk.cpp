@@ -0,0 +1,397 @@
+#include <engine/component/chunk.h>
+#include <engine/system/terrain_generator.h>
+
+#include <algorithm>
+#include <array>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+TEST_CASE("Chunk get/set across sections") {
+    Chunk chunk{{0, 0}};
+
+    chunk.setBlock(1, 2 * chunkSectionHeight + 3, 4, {BlockType::Grass});
+    REQUIRE(chunk.getBlock({1, 2 * chunkSectionHeight + 3, 4}).type ==
+            BlockType::Grass);
+    REQUIRE(chunk.getBlock({1, 2 * chunkSectionHeight + 2, 4}).type ==
+            BlockType::Empty);
+    REQUIRE_FALSE(chunk.isSectionEmpty(2));
+    REQUIRE_FALSE(chunk.isSectionFull(2));
+
+    chunk.setBlock(1, 2 * chunkSectionHeight + 3, 4, {BlockType::Empty});
+    REQUIRE(chunk.getBlock({1, 2 * chunkSectionHeight + 3, 4}).type ==
+            BlockType::Empty);
+}
+
+TEST_CASE("Compacting makes the emptied sections uniform again") {
+    Chunk chunk{{0, 0}};
+    const auto bytes = chunk.bytes();
+
+    auto dirty = chunk.setBlock(1, 2 * chunkSectionHeight + 3, 4,
+                                {BlockType::Grass});
+    chunk.setBlock(5, 3, 6, {BlockType::Grass});
+    chunk.setBlock(5, 3, 6, {BlockType::Empty});
+    dirty |= chunk.setBlock(1, 2 * chunkSectionHeight + 3, 4,
+                            {BlockType::Empty});
+    // Grass is still in their palettes
+    REQUIRE_FALSE(chunk.isSectionEmpty(0));
+    REQUIRE_FALSE(chunk.isSectionEmpty(2));
+
+    // Only the given sections
+    chunk.compactSections(dirty);
+    REQUIRE(chunk.isSectionEmpty(2));
+    REQUIRE_FALSE(chunk.isSectionEmpty(0));
+
+    chunk.compactSections(sectionMaskOf(3));
+    REQUIRE(chunk.isSectionEmpty(0));
+    REQUIRE(chunk.bytes() == bytes);
+}
+
+TEST_CASE("New chunks are only air") {
+    Chunk chunk{{3, 17}};
+
+    for (std::size_t section = 0; section < chunkSectionCount; section++)
+        REQUIRE(chunk.isSectionEmpty(section));
+    REQUIRE(chunk.bytes() < chunkSectionCount * chunkSectionBlockCount);
+}
+
+TEST_CASE("Chunk heightmap follows the edits") {
+    Chunk chunk{{0, 0}};
+    REQUIRE(chunk.getHeight(1, 2) == -1);
+    REQUIRE(chunk.getMaxHeight() == -1);
+
+    chunk.setBlock(1, 40, 2, {BlockType::Grass});
+    chunk.setBlock(1, 3, 2, {BlockType::Grass});
+    REQUIRE(chunk.getHeight(1, 2) == 40);
+    REQUIRE(chunk.getHeight(2, 1) == -1);
+    REQUIRE(chunk.getMaxHeight() == 40);
+
+    // Removing the top block uncovers the one below
+    chunk.setBlock(1, 40, 2, {BlockType::Empty});
+    REQUIRE(chunk.getHeight(1, 2) == 3);
+
+    chunk.fillSection(1, {BlockType::Grass});
+    REQUIRE(chunk.getHeight(1, 2) == 2 * chunkSectionHeight - 1);
+    REQUIRE(chunk.getHeight(2, 1) == 2 * chunkSectionHeight - 1);
+
+    chunk.fillSection(1, {BlockType::Empty});
+    REQUIRE(chunk.getHeight(1, 2) == 3);
+    REQUIRE(chunk.getHeight(2, 1) == -1);
+}
+
+TEST_CASE("Chunk heightmap is rebuilt from sections") {
+    Chunk chunk{{0, 0}};
+    chunk.setBlock(4, 100, 5, {BlockType::Grass});
+    chunk.setBlock(0, 7, 0, {BlockType::Grass});
+
+    std::array<block_storage, chunkSectionCount> sections;
+    for (std::size_t i = 0; i < chunkSectionCount; i++)
+        sections[i] = chunk.getSection(i);
+    Chunk copy{{0, 0}, std::move(sections)};
+
+    for (std::size_t z = 0; z < chunkWidth; z++)
+        for (std::size_t x = 0; x < chunkWidth; x++)
+            REQUIRE(copy.getHeight(x, z) == chunk.getHeight(x, z));
+}
+
+namespace {
+using mesh_type = ChunkSimplifyerProxy::mesh_type;
+
+// Faces of a mesh, sorted, to compare meshes built in different orders
+std::vector<std::vector<float>> sorted_faces(const mesh_type& mesh) {
+    std::vector<std::vector<float>> faces;
+    for (std::size_t i = 0; i < mesh.size(); i += verticesPerQuad) {
+        std::vector<float> face;
+        for (std::size_t j = i; j < i + verticesPerQuad; j++) {
+            const auto& vertex = mesh.data()[j];  // NOLINT
+            const auto position = vertex.position();
+            face.insert(face.end(), {position[0], position[1], position[2],
+                                     static_cast<float>(vertex.face()),
+                                     static_cast<float>(vertex.texture())});
+        }
+        faces.push_back(std::move(face));
+    }
+    std::sort(faces.begin(), faces.end());
+    return faces;
+}
+
+Chunk test_terrain() {
+    Chunk chunk = TerrainGenerator{7}.generate({1, -4});
+    // Holes, floating blocks and a block on the top of the chunk
+    chunk.setBlock(3, 2, 3, {BlockType::Empty});
+    chunk.setBlock(0, 5, 7, {BlockType::Empty});
+    chunk.setBlock(5, 60, 2, {BlockType::Grass});
+    chunk.setBlock(7, 61, 2, {BlockType::Grass});
+    chunk.setBlock(2, chunkHeight - 1, 6, {BlockType::Grass});
+    return chunk;
+}
+}  // namespace
+
+TEST_CASE("Bitmask meshing gives the same faces as the per block one") {
+    ChunkSimplifyerProxy proxy{test_terrain()};
+    const auto bitmask = sorted_faces(proxy.mesh);
+    REQUIRE_FALSE(bitmask.empty());
+
+    proxy.simplifyPerBlock();
+    REQUIRE(bitmask == sorted_faces(proxy.mesh));
+
+    ChunkSimplifyerProxy empty{Chunk{{0, 0}}};
+    REQUIRE(empty.mesh.size() == 0);
+}
+
+TEST_CASE("Chunk meshing benchmark", "[.][benchmark]") {
+    ChunkSimplifyerProxy proxy{test_terrain()};
+
+    const int runs = 200;
+    auto time = [&](auto&& simplify) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < runs; i++) simplify();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             start)
+            .count();
+    };
+    const double per_block = time([&] { proxy.simplifyPerBlock(); });
+    const double bitmask = time([&] { proxy.simplify(); });
+    WARN("bitmask meshing is " << per_block / bitmask
+                               << " times faster than per block");
+
+    BENCHMARK("per block") {
+        proxy.simplifyPerBlock();
+        return proxy.mesh.size();
+    };
+    BENCHMARK("bitmask") {
+        proxy.simplify();
+        return proxy.mesh.size();
+    };
+}
+
+namespace {
+// Area covered by the faces of a mesh, by face normal and texture
+std::map<std::tuple<float, float, float, int>, float> face_areas(
+    const mesh_type& mesh) {
+    std::map<std::tuple<float, float, float, int>, float> areas;
+    const auto indices = quadIndices(mesh.quadCount());
+    for (std::size_t i = 0; i < indices.size(); i += 3) {
+        const auto* v = mesh.data();
+        const auto p0 = v[indices[i]].position();            // NOLINT
+        const auto e1 = v[indices[i + 1]].position() - p0;  // NOLINT
+        const auto e2 = v[indices[i + 2]].position() - p0;  // NOLINT
+        const math::vec3f normal{e1[1] * e2[2] - e1[2] * e2[1],
+                                 e1[2] * e2[0] - e1[0] * e2[2],
+                                 e1[0] * e2[1] - e1[1] * e2[0]};
+        const float area = std::sqrt(math::norm2(normal)) / 2;
+        areas[{normal[0] / (2 * area), normal[1] / (2 * area),
+               normal[2] / (2 * area),
+               static_cast<int>(v[indices[i]].texture())}] +=  // NOLINT
+            area;
+    }
+    return areas;
+}
+}  // namespace
+
+TEST_CASE("Greedy meshing covers the same faces with fewer vertices") {
+    ChunkSimplifyerProxy proxy{test_terrain()};
+    const auto per_face_areas = face_areas(proxy.mesh);
+    const auto per_face_size = proxy.mesh.size();
+
+    proxy.setMeshingMode(MeshingMode::Greedy);
+    REQUIRE(proxy.mesh.size() < per_face_size);
+
+    const auto greedy_areas = face_areas(proxy.mesh);
+    REQUIRE(greedy_areas.size() == per_face_areas.size());
+    for (const auto& [key, area] : per_face_areas)
+        REQUIRE(greedy_areas.at(key) == Approx(area));
+}
+
+TEST_CASE("Greedy meshing merges a flat layer into one quad") {
+    Chunk chunk{{0, 0}};
+    for (int z = 0; z < chunkWidth; z++)
+        for (int x = 0; x < chunkWidth; x++)
+            chunk.setBlock(x, 0, z, {BlockType::Grass});
+    ChunkSimplifyerProxy proxy{std::move(chunk), MeshingMode::Greedy};
+
+    // Top, bottom and the 4 sides
+    REQUIRE(proxy.mesh.quadCount() == 6);
+
+    // The quads span the whole chunk
+    float max_x = 0;
+    float max_z = 0;
+    for (std::size_t i = 0; i < proxy.mesh.size(); i++) {
+        const auto position = proxy.mesh.data()[i].position();  // NOLINT
+        max_x = std::max(max_x, position[0]);
+        max_z = std::max(max_z, position[2]);
+    }
+    REQUIRE(max_x == chunkWidth);
+    REQUIRE(max_z == chunkWidth);
+}
+
+TEST_CASE("Meshing hides the faces against the neighbouring chunks") {
+    const TerrainGenerator generator{7};
+    chunk_neighbours neighbours;
+    for (std::size_t i = 0; i < neighbours.size(); i++)
+        neighbours[i] = std::make_shared<const Chunk>(generator.generate(
+            {1 + neighbourOffsets[i].x, -4 + neighbourOffsets[i].z}));
+
+    ChunkSimplifyerProxy alone{test_terrain()};
+    ChunkSimplifyerProxy proxy{test_terrain(), MeshingMode::PerFace,
+                               neighbours};
+    REQUIRE(proxy.mesh.size() < alone.mesh.size());
+    for (std::size_t i = 0; i < neighbours.size(); i++) {
+        REQUIRE(proxy.hasNeighbour(i));
+        REQUIRE_FALSE(alone.hasNeighbour(i));
+    }
+
+    const auto bitmask = sorted_faces(proxy.mesh);
+    proxy.simplifyPerBlock(neighbours);
+    REQUIRE(bitmask == sorted_faces(proxy.mesh));
+
+    // Only some of the neighbours
+    neighbours[1] = nullptr;
+    neighbours[2] = nullptr;
+    proxy.simplify(neighbours);
+    const auto partial = sorted_faces(proxy.mesh);
+    proxy.simplifyPerBlock(neighbours);
+    REQUIRE(partial == sorted_faces(proxy.mesh));
+    REQUIRE(proxy.hasNeighbour(0));
+    REQUIRE_FALSE(proxy.hasNeighbour(1));
+}
+
+TEST_CASE("No faces between two full chunks") {
+    auto full = [](chunk_identifier id) {
+        Chunk chunk{id};
+        chunk.fillSection(0, {BlockType::Grass});
+        return chunk;
+    };
+
+    chunk_neighbours neighbours;
+    for (std::size_t i = 0; i < neighbours.size(); i++)
+        neighbours[i] = std::make_shared<const Chunk>(
+            full({neighbourOffsets[i].x, neighbourOffsets[i].z}));
+
+    // Only the top and the bottom are left
+    ChunkSimplifyerProxy proxy{full({0, 0}), MeshingMode::Greedy, neighbours};
+    REQUIRE(proxy.mesh.quadCount() == 2);
+}
+
+TEST_CASE("Editing a block only remeshes the dirty sections") {
+    const TerrainGenerator generator{7};
+    chunk_neighbours neighbours;
+    for (std::size_t i = 0; i < neighbours.size(); i++)
+        neighbours[i] = std::make_shared<const Chunk>(generator.generate(
+            {1 + neighbourOffsets[i].x, -4 + neighbourOffsets[i].z}));
+
+    // On section borders, on the chunk borders, on the top of the columns
+    const int top = test_terrain().getHeight(4, 4);
+    const std::vector<std::tuple<int, int, int, BlockType>> edits{
+        {3, chunkSectionHeight, 3, BlockType::Empty},
+        {3, chunkSectionHeight - 1, 3, BlockType::Empty},
+        {4, top, 4, BlockType::Empty},
+        {4, top + 1, 4, BlockType::Grass},
+        {4, top + 2, 4, BlockType::Grass},
+        {4, top + 2 * chunkSectionHeight, 4, BlockType::Grass},
+        {0, 2 * chunkSectionHeight, 5, BlockType::Grass},
+        {chunkWidth - 1, 1, chunkWidth - 1, BlockType::Empty},
+        {2, chunkHeight - 1, 6, BlockType::Empty},
+    };
+
+    for (auto mode : {MeshingMode::PerFace, MeshingMode::Greedy}) {
+        ChunkSimplifyerProxy proxy{test_terrain(), mode, neighbours};
+        for (const auto& [x, y, z, type] : edits) {
+            auto blocks = std::make_shared<Chunk>(proxy.getChunk());
+            const section_mask dirty = blocks->setBlock(x, y, z, {type});
+
+            const std::vector<PackedBlockVertex> before(
+                proxy.mesh.data(), proxy.mesh.data() + proxy.mesh.size());
+            const auto first = proxy.remeshSections(blocks, dirty, neighbours);
+
+            // Same faces as a whole remesh
+            const ChunkSimplifyerProxy rebuilt{blocks, mode, neighbours};
+            REQUIRE(sorted_faces(proxy.mesh) == sorted_faces(rebuilt.mesh));
+
+            // The vertices before the first dirty section did not move
+            REQUIRE(first <= std::min(before.size(), proxy.mesh.size()));
+            for (std::size_t i = 0; i < first; i++)
+                REQUIRE(proxy.mesh.data()[i].data == before[i].data);  // NOLINT
+        }
+    }
+}
+
+TEST_CASE("Editing a block on a border remeshes the neighbour") {
+    const TerrainGenerator generator{7};
+    auto chunk = std::make_shared<const Chunk>(generator.generate({0, 0}));
+
+    for (std::size_t i = 0; i < neighbourOffsets.size(); i++) {
+        const auto [x, z] = neighbourOffsets[i];
+        auto neighbour = std::make_shared<Chunk>(generator.generate({x, z}));
+        chunk_neighbours neighbours;
+        neighbours[i] = neighbour;
+        ChunkSimplifyerProxy proxy{chunk, MeshingMode::Greedy, neighbours};
+
+        // Digs the column of the neighbour that touches the chunk
+        const std::size_t opposite = oppositeNeighbour(i);
+        const int column_x = x == 0 ? 3 : (x > 0 ? 0 : chunkWidth - 1);
+        const int column_z = z == 0 ? 3 : (z > 0 ? 0 : chunkWidth - 1);
+        const int height = neighbour->getHeight(column_x, column_z);
+        const int y = height / 2;
+        neighbour->setBlock(column_x, y, column_z, {BlockType::Empty});
+        const section_mask dirty =
+            borderSections(opposite, column_x, y, column_z);
+        REQUIRE(dirty == sectionMaskOf(y));
+
+        proxy.remeshSections(chunk, dirty, neighbours);
+        const ChunkSimplifyerProxy rebuilt{chunk, MeshingMode::Greedy,
+                                           neighbours};
+        REQUIRE(sorted_faces(proxy.mesh) == sorted_faces(rebuilt.mesh));
+
+        // Not on the border of the other neighbours
+        for (std::size_t j = 0; j < neighbourOffsets.size(); j++)
+            if (j != opposite)
+                REQUIRE(borderSections(j, column_x, y, column_z) == 0);
+    }
+}
+
+TEST_CASE("Merged faces repeat the texture once per block") {
+    MeshChunk mesh;
+    mesh.addBlockFace({0, 3, 0}, FaceKind::Top, BlockTexture::GrassTop,
+                      {5, 1, 2});
+
+    float max_s = 0;
+    float max_t = 0;
+    for (std::size_t i = 0; i < mesh.size(); i++) {
+        max_s = std::max(max_s, mesh.data()[i].textpos[0]);  // NOLINT
+        max_t = std::max(max_t, mesh.data()[i].textpos[1]);  // NOLINT
+    }
+    REQUIRE(max_s == 5);
+    REQUIRE(max_t == 2);
+}
+
+TEST_CASE("Quads share the same indices") {
+    const auto indices = quadIndices(2);
+    REQUIRE(indices == std::vector<quad_index>{0, 1, 2, 0, 3, 1,  //
+                                               4, 5, 6, 4, 7, 5});
+
+    // The two triangles of a face turn the same way: one normal per face
+    mesh_type mesh;
+    for (std::size_t kind = 0; kind < faceKindCount; kind++)
+        mesh.addBlockFace({0, 0, 0}, static_cast<FaceKind>(kind),
+                          BlockTexture::GrassTop);
+    REQUIRE(mesh.quadCount() == faceKindCount);
+    REQUIRE(face_areas(mesh).size() == faceKindCount);
+}
+
+TEST_CASE("Packed vertices round trip") {
+    const auto vertex = PackedBlockVertex::make(
+        {chunkWidth, chunkHeight, 3}, {}, BlockTexture::GrassSide,
+        FaceKind::Right);
+
+    REQUIRE(sizeof(vertex) == 4);
+    REQUIRE(vertex.position() == math::vec3f{chunkWidth, chunkHeight, 3});
+    REQUIRE(vertex.face() == FaceKind::Right);
+    REQUIRE(vertex.texture() == BlockTexture::GrassSide);
+}
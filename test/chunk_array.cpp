@@ -0,0 +1,166 @@
+#include <engine/data_structure/chunk_array.h>
+
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include <functional>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace {
+struct counting_factory {
+    std::size_t calls = 0;
+    std::pair<int, int> operator()(int x, int y) {
+        calls++;
+        return {x, y};
+    }
+};
+
+// Every element must be in the window centered on (x, y), exactly once
+void require_window(chunk_array<std::pair<int, int>>& array, int x, int y,
+                    int half_size) {
+    std::set<std::pair<int, int>> seen;
+    for (auto& id : array) {
+        REQUIRE(std::abs(id.first - x) <= half_size);
+        REQUIRE(std::abs(id.second - y) <= half_size);
+        seen.insert(id);
+    }
+    REQUIRE(seen.size() == array.size() * array.size());
+}
+}  // namespace
+
+TEST_CASE("chunk_array only regenerates exposed rows and columns") {
+    const int half_size = 3;
+    chunk_array<std::pair<int, int>> array{half_size};
+    counting_factory factory;
+    array.set_factory(std::ref(factory));
+
+    REQUIRE(factory.calls == array.size() * array.size());
+    require_window(array, 0, 0, half_size);
+
+    factory.calls = 0;
+    array.move_current_position(1, 0);
+    REQUIRE(factory.calls == array.size());
+    require_window(array, 1, 0, half_size);
+
+    factory.calls = 0;
+    array.move_current_position(0, -1);
+    REQUIRE(factory.calls == array.size());
+    require_window(array, 1, -1, half_size);
+
+    factory.calls = 0;
+    array.move_current_position(-1, 1);
+    REQUIRE(factory.calls == 2 * array.size() - 1);
+    require_window(array, 0, 0, half_size);
+
+    factory.calls = 0;
+    array.set_current_position(-5, -9);
+    REQUIRE(factory.calls == array.size() * array.size());
+    require_window(array, -5, -9, half_size);
+
+    factory.calls = 0;
+    array.move_current_position(0, 0);
+    REQUIRE(factory.calls == 0);
+}
+
+TEST_CASE("chunk_array evicts elements getting out of the window") {
+    chunk_array<std::pair<int, int>> array{1};
+    std::vector<std::pair<int, int>> evicted;
+    array.set_evict_callback(
+        [&](std::pair<int, int>&& id) { evicted.push_back(id); });
+    array.set_factory([](int x, int y) { return std::pair{x, y}; });
+    REQUIRE(evicted.empty());
+
+    array.move_current_position(1, 0);
+    REQUIRE(evicted.size() == array.size());
+    for (auto id : evicted) REQUIRE(id.first == -1);
+}
+
+TEST_CASE("chunk_array find/at") {
+    const int half_size = 2;
+    chunk_array<std::pair<int, int>> array{half_size};
+    array.set_factory([](int x, int y) { return std::pair{x, y}; });
+    array.set_current_position(-7, 4);
+
+    for (int x = -7 - half_size; x <= -7 + half_size; x++) {
+        for (int z = 4 - half_size; z <= 4 + half_size; z++) {
+            auto* found = array.find({x, z});
+            REQUIRE(found != nullptr);
+            REQUIRE(*found == std::pair{x, z});
+            REQUIRE(array.at(x, z) == found);
+        }
+    }
+
+    REQUIRE(array.find({-7 - half_size - 1, 4}) == nullptr);
+    REQUIRE(array.at(-7, 4 + half_size + 1) == nullptr);
+    REQUIRE(array.at(0, 0) == nullptr);
+}
+
+TEST_CASE("floor_div and positive_modulo round towards negative infinity") {
+    for (int a = -40; a <= 40; a++) {
+        const int q = floor_div(a, 16);
+        const int r = positive_modulo(a, 16);
+        REQUIRE(0 <= r);
+        REQUIRE(r < 16);
+        REQUIRE(q * 16 + r == a);
+    }
+    REQUIRE(floor_div(-1, 16) == -1);
+    REQUIRE(floor_div(-16, 16) == -1);
+    REQUIRE(floor_div(-17, 16) == -2);
+}
+
+namespace {
+// The previous layout of chunk_array, kept as a baseline
+struct nested_chunk_array {
+    std::vector<std::vector<std::pair<int, int>>> data;
+    int size;
+
+    explicit nested_chunk_array(int size)
+        : data(static_cast<std::size_t>(size)), size(size) {
+        for (int i = 0; i < size; i++)
+            for (int j = 0; j < size; j++)
+                data[static_cast<std::size_t>(i)].emplace_back(i, j);
+    }
+
+    // Same modular indexing as chunk_array, but through the nested vectors
+    std::pair<int, int>* find(int x, int z) {
+        auto i = static_cast<std::size_t>(((x % size) + size) % size);
+        auto j = static_cast<std::size_t>(((z % size) + size) % size);
+        return &data[i][j];
+    }
+};
+}  // namespace
+
+TEST_CASE("chunk_array benchmark", "[.][benchmark]") {
+    chunk_array<std::pair<int, int>> array;
+    array.set_factory([](int x, int y) { return std::pair{x, y}; });
+    nested_chunk_array nested{static_cast<int>(array.size())};
+    const int half = static_cast<int>(default_half_size);
+
+    BENCHMARK("flat find") {
+        int sum = 0;
+        for (int x = -half; x <= half; x++)
+            for (int z = -half; z <= half; z++) sum += array.at(x, z)->first;
+        return sum;
+    };
+
+    BENCHMARK("nested find") {
+        int sum = 0;
+        for (int x = -half; x <= half; x++)
+            for (int z = -half; z <= half; z++) sum += nested.find(x, z)->first;
+        return sum;
+    };
+
+    BENCHMARK("flat iteration") {
+        int sum = 0;
+        for (auto& id : array) sum += id.first;
+        return sum;
+    };
+
+    BENCHMARK("nested iteration") {
+        int sum = 0;
+        for (auto& row : nested.data)
+            for (auto& id : row) sum += id.first;
+        return sum;
+    };
+}
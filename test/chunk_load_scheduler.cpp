@@ -0,0 +1,63 @@
+#include <engine/system/chunk_load_scheduler.h>
+
+#include <catch2/catch.hpp>
+#include <cstdlib>
+
+namespace {
+const int width = 8;
+const auto everything = [](chunk_identifier /*id*/) { return true; };
+}  // namespace
+
+TEST_CASE("ChunkLoadScheduler nearest chunks first") {
+    ChunkLoadScheduler scheduler{width};
+    scheduler.update({0, 0, 0}, {0, 0, -1}, everything);
+
+    scheduler.request({0, -5});
+    scheduler.request({0, -1});
+    scheduler.request({0, -3});
+
+    REQUIRE(scheduler.pop() == chunk_identifier{0, -1});
+    REQUIRE(scheduler.pop() == chunk_identifier{0, -3});
+    REQUIRE(scheduler.pop() == chunk_identifier{0, -5});
+    REQUIRE_FALSE(scheduler.pop().has_value());
+}
+
+TEST_CASE("ChunkLoadScheduler chunks in view first") {
+    ChunkLoadScheduler scheduler{width};
+    scheduler.request({0, 3});   // behind
+    scheduler.request({0, -4});  // in front, but farther
+
+    scheduler.update({4, 0, 4}, {0, 0, -1}, everything);
+    REQUIRE(scheduler.pop() == chunk_identifier{0, -4});
+
+    scheduler.request({0, -4});
+    scheduler.update({4, 0, 4}, {0, 0, 1}, everything);  // turned around
+    REQUIRE(scheduler.pop() == chunk_identifier{0, 3});
+}
+
+TEST_CASE("ChunkLoadScheduler chunks behind count as behind_penalty farther") {
+    static_assert(ChunkLoadScheduler::behind_penalty == 4);
+    ChunkLoadScheduler scheduler{width};
+    scheduler.request({0, 3});    // behind, 3 chunks away
+    scheduler.request({0, -11});  // in front, 11 chunks away
+    scheduler.request({0, -13});  // in front, 13 chunks away
+
+    scheduler.update({4, 0, 4}, {0, 0, -1}, everything);
+    REQUIRE(scheduler.pop() == chunk_identifier{0, -11});
+    REQUIRE(scheduler.pop() == chunk_identifier{0, 3});
+    REQUIRE(scheduler.pop() == chunk_identifier{0, -13});
+}
+
+TEST_CASE("ChunkLoadScheduler drops unwanted chunks") {
+    ChunkLoadScheduler scheduler{width};
+    for (int x = -10; x <= 10; x++) scheduler.request({x, 0});
+
+    // teleported around x = 10
+    scheduler.update({80, 0, 0}, {0, 0, -1}, [](chunk_identifier id) {
+        return std::abs(id.x - 10) <= 2;
+    });
+
+    REQUIRE(scheduler.pending_count() == 3);
+    REQUIRE(scheduler.cancelled_count() == 18);
+    REQUIRE(scheduler.pop() == chunk_identifier{10, 0});
+}
@@ -0,0 +1,32 @@
+#include <engine/data_structure/draw_command_list.h>
+
+#include <array>
+#include <catch2/catch.hpp>
+
+TEST_CASE("draw_command_list builds one command per draw") {
+    draw_command_list<std::array<int, 2>> draws;
+    draws.add(12, 0, {0, 0});
+    draws.add(0, 8, {1, 0});  // empty mesh, nothing to draw
+    draws.add(6, 100, {-1, 2});
+
+    REQUIRE(draws.size() == 2);
+    const auto& commands = draws.commands();
+    REQUIRE(commands[0].count == 12);
+    REQUIRE(commands[0].base_vertex == 0);
+    REQUIRE(commands[1].count == 6);
+    REQUIRE(commands[1].base_vertex == 100);
+    for (const auto& command : commands) {
+        REQUIRE(command.instance_count == 1);
+        REQUIRE(command.first_index == 0);
+    }
+
+    // The instance of a draw is found at its base instance
+    REQUIRE(draws.instances().size() == 2);
+    REQUIRE(draws.instances()[commands[1].base_instance] ==
+            std::array{-1, 2});
+
+    draws.clear();
+    REQUIRE(draws.empty());
+    draws.add(6, 4, {3, 3});
+    REQUIRE(draws.commands()[0].base_instance == 0);
+}
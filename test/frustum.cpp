@@ -0,0 +1,66 @@
+#include <engine/utils/frustum.h>
+#include <engine/utils/mat.h>
+#include <engine/utils/mat_opengl.h>
+
+#include <catch2/catch.hpp>
+#include <numbers>
+
+namespace {
+// Looking toward -z from the origin, the same as CameraController
+const auto proj =
+    math::projection<float>(1, std::numbers::pi_v<float> / 2, 1, 80);
+
+math::aabb box(math::vec3f center, float half_size) {
+    const math::vec3f half{half_size, half_size, half_size};
+    return {center - half, center + half};
+}
+}  // namespace
+
+TEST_CASE("math::frustum keeps the boxes in front of the camera") {
+    const auto frustum = math::extractFrustum(proj);
+
+    REQUIRE(math::intersects(frustum, box({0, 0, -10}, 1)));
+    REQUIRE(math::intersects(frustum, box({8, -8, -10}, 1)));
+    // Across the near plane, or the far plane
+    REQUIRE(math::intersects(frustum, box({0, 0, 0}, 2)));
+    REQUIRE(math::intersects(frustum, box({0, 0, -80}, 2)));
+
+    REQUIRE_FALSE(math::intersects(frustum, box({0, 0, 10}, 1)));
+    REQUIRE_FALSE(math::intersects(frustum, box({0, 0, 0}, 0.5)));
+    REQUIRE_FALSE(math::intersects(frustum, box({0, 0, -90}, 1)));
+    REQUIRE_FALSE(math::intersects(frustum, box({20, 0, -10}, 1)));
+    REQUIRE_FALSE(math::intersects(frustum, box({0, -20, -10}, 1)));
+}
+
+TEST_CASE("math::frustum follows the camera") {
+    // Camera at x = 100 looking toward +z
+    const auto view = math::rotate<float, 4>(std::numbers::pi,
+                                             math::vec3f{0, 1, 0}) *
+                      math::translation<float>(-100, 0, 0);
+    const auto frustum = math::extractFrustum(proj * view);
+
+    REQUIRE(math::intersects(frustum, box({100, 0, 10}, 1)));
+    REQUIRE_FALSE(math::intersects(frustum, box({100, 0, -10}, 1)));
+    REQUIRE_FALSE(math::intersects(frustum, box({0, 0, -10}, 1)));
+}
+
+TEST_CASE("math::frustum culls most of a window of chunks") {
+    const auto frustum = math::extractFrustum(proj);
+    const int width = 8;
+    const int radius = 12;
+
+    int drawn = 0;
+    for (int x = -radius; x <= radius; x++) {
+        for (int z = -radius; z <= radius; z++) {
+            const math::aabb chunk{
+                {static_cast<float>(x * width), 0,
+                 static_cast<float>(z * width)},
+                {static_cast<float>((x + 1) * width), 256,
+                 static_cast<float>((z + 1) * width)}};
+            if (math::intersects(frustum, chunk)) drawn++;
+        }
+    }
+    const int total = (2 * radius + 1) * (2 * radius + 1);
+    REQUIRE(drawn > 0);
+    REQUIRE(2 * drawn < total);
+}
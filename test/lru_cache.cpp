@@ -0,0 +1,37 @@
+#include <engine/data_structure/lru_cache.h>
+
+#include <catch2/catch.hpp>
+#include <string>
+
+TEST_CASE("lru_cache hits and misses") {
+    lru_cache<int, std::string> cache{100};
+    cache.put(1, "one", 10);
+    cache.put(2, "two", 10);
+
+    REQUIRE(cache.take(1) == "one");
+    REQUIRE_FALSE(cache.take(1).has_value());  // taken out
+    REQUIRE_FALSE(cache.take(3).has_value());
+
+    REQUIRE(cache.hit_count() == 1);
+    REQUIRE(cache.miss_count() == 2);
+    REQUIRE(cache.bytes() == 10);
+}
+
+TEST_CASE("lru_cache evicts least recently used first") {
+    lru_cache<int, std::string> cache{30};
+    cache.put(1, "one", 10);
+    cache.put(2, "two", 10);
+    cache.put(3, "three", 10);
+    cache.put(1, "one again", 10);  // 1 is now the most recent
+
+    cache.put(4, "four", 15);
+    REQUIRE(cache.bytes() == 25);
+    REQUIRE(cache.eviction_count() == 2);
+    REQUIRE_FALSE(cache.take(2).has_value());
+    REQUIRE_FALSE(cache.take(3).has_value());
+    REQUIRE(cache.take(1) == "one again");
+    REQUIRE(cache.take(4) == "four");
+
+    cache.put(5, "too big", 31);
+    REQUIRE(cache.size() == 0);
+}
@@ -0,0 +1,175 @@
+#include <engine/component/chunk.h>
+#include <engine/system/occlusion_culler.h>
+#include <engine/utils/frustum.h>
+#include <engine/utils/mat_opengl.h>
+
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <memory>
+#include <numbers>
+#include <unordered_map>
+
+namespace {
+const BlockData stone{BlockType::Grass};
+
+// Visibility of the sections of chunk
+chunk_visibility visibilityOf(Chunk chunk) {
+    return ChunkSimplifyerProxy{std::move(chunk)}.getVisibility();
+}
+
+// A floor at y across the whole chunk
+Chunk withFloor(chunk_identifier id, int y) {
+    Chunk chunk{id};
+    for (int z = 0; z < chunkWidth; z++)
+        for (int x = 0; x < chunkWidth; x++) chunk.setBlock(x, y, z, stone);
+    return chunk;
+}
+
+bool connected(const section_visibility& visibility, FaceKind from,
+               FaceKind to) {
+    return visibility.connected(from, to) && visibility.connected(to, from);
+}
+}  // namespace
+
+TEST_CASE("Sections connect the faces their air touches") {
+    const auto air = visibilityOf(Chunk{{0, 0}});
+    REQUIRE(air[0] == section_visibility::all());
+
+    Chunk filled{{0, 0}};
+    filled.fillSection(1, stone);
+    REQUIRE(visibilityOf(std::move(filled))[1] == section_visibility{});
+
+    // The floor cuts the section in two
+    const int floor = chunkSectionHeight + 5;
+    const auto cut = visibilityOf(withFloor({0, 0}, floor))[1];
+    REQUIRE(connected(cut, FaceKind::Top, FaceKind::Left));
+    REQUIRE(connected(cut, FaceKind::Bottom, FaceKind::Left));
+    REQUIRE(connected(cut, FaceKind::Front, FaceKind::Right));
+    REQUIRE_FALSE(connected(cut, FaceKind::Top, FaceKind::Bottom));
+
+    // Until there is a hole in it, in a corner of the chunk
+    auto holed = withFloor({0, 0}, floor);
+    holed.setBlock(chunkWidth - 1, floor, 0, {});
+    REQUIRE(connected(visibilityOf(std::move(holed))[1], FaceKind::Top,
+                      FaceKind::Bottom));
+
+    // A wall across x
+    Chunk wall{{0, 0}};
+    for (int y = 0; y < chunkSectionHeight; y++)
+        for (int z = 0; z < chunkWidth; z++) wall.setBlock(3, y, z, stone);
+    const auto walled = visibilityOf(std::move(wall))[0];
+    REQUIRE_FALSE(connected(walled, FaceKind::Left, FaceKind::Right));
+    REQUIRE(connected(walled, FaceKind::Top, FaceKind::Bottom));
+    REQUIRE(connected(walled, FaceKind::Left, FaceKind::Front));
+    REQUIRE(connected(walled, FaceKind::Right, FaceKind::Back));
+}
+
+TEST_CASE("Remeshing updates the visibility of the sections") {
+    const int floor = 5;
+    ChunkSimplifyerProxy chunk{withFloor({0, 0}, floor)};
+    REQUIRE_FALSE(
+        chunk.getVisibility()[0].connected(FaceKind::Top, FaceKind::Bottom));
+
+    auto edited = std::make_shared<Chunk>(chunk.getChunk());
+    const auto dirty = edited->setBlock(2, floor, 2, {});
+    chunk.remeshSections(std::move(edited), dirty);
+    REQUIRE(
+        chunk.getVisibility()[0].connected(FaceKind::Top, FaceKind::Bottom));
+}
+
+namespace {
+// Chunks with some visibility, the others are only air
+struct test_world {
+    std::unordered_map<chunk_identifier, chunk_visibility,
+                       chunk_identifier_hash>
+        chunks;
+
+    [[nodiscard]] OcclusionCuller::visibility_lookup lookup() const {
+        return [this](chunk_identifier id) -> const chunk_visibility* {
+            auto it = chunks.find(id);
+            return it == chunks.end() ? nullptr : &it->second;
+        };
+    }
+};
+
+const section_mask allSections = (section_mask{1} << chunkSectionCount) - 1;
+const math::vec3f camera{4, 20, 4};  // in the section 1 of the chunk 0 0
+}  // namespace
+
+TEST_CASE("OcclusionCuller sees everything through air") {
+    const test_world world;
+    OcclusionCuller culler;
+    const int radius = 3;
+    culler.update(camera, radius, world.lookup());
+
+    for (int x = -radius; x <= radius; x++)
+        for (int z = -radius; z <= radius; z++)
+            REQUIRE(culler.visibleSections({x, z}) == allSections);
+    REQUIRE(culler.visibleSectionCount() ==
+            (2 * radius + 1) * (2 * radius + 1) * chunkSectionCount);
+    REQUIRE(culler.visibleSections({radius + 1, 0}) == 0);
+}
+
+TEST_CASE("OcclusionCuller does not see behind walls") {
+    test_world world;
+    const int radius = 3;
+    chunk_visibility wall{};  // only full sections
+    for (int z = -radius; z <= radius; z++) world.chunks[{1, z}] = wall;
+
+    OcclusionCuller culler;
+    culler.update(camera, radius, world.lookup());
+    for (int z = -radius; z <= radius; z++) {
+        REQUIRE(culler.visibleSections({0, z}) == allSections);
+        // The wall is seen, not what is behind it
+        REQUIRE(culler.visibleSections({1, z}) == allSections);
+        REQUIRE(culler.visibleSections({2, z}) == 0);
+    }
+
+    // Closed room around the camera: only its walls are seen
+    world.chunks.clear();
+    chunk_visibility room{};
+    room.fill(section_visibility::all());
+    room[0] = room[2] = section_visibility{};
+    for (int x = -1; x <= 1; x++)
+        for (int z = -1; z <= 1; z++)
+            world.chunks[{x, z}] = x == 0 && z == 0 ? room : wall;
+    culler.update(camera, radius, world.lookup());
+    REQUIRE(culler.visibleSections({0, 0}) == 0b111U);
+    REQUIRE(culler.visibleSections({1, 0}) == 0b010U);
+    REQUIRE(culler.visibleSections({1, 1}) == 0);
+    REQUIRE(culler.visibleSections({2, 0}) == 0);
+    REQUIRE(culler.visibleSectionCount() == 3 + 4);
+}
+
+TEST_CASE("OcclusionCuller keeps what is around corners") {
+    // A wall at x = 1 with a way through the top of its sections at z = 2:
+    // the chunks behind the wall are seen through it
+    test_world world;
+    const int radius = 3;
+    chunk_visibility wall{};
+    for (int z = -radius; z <= radius; z++) world.chunks[{1, z}] = wall;
+    world.chunks[{1, 2}].fill(section_visibility::all());
+
+    OcclusionCuller culler;
+    culler.update(camera, radius, world.lookup());
+    REQUIRE(culler.visibleSections({2, 2}) == allSections);
+    REQUIRE(culler.visibleSections({3, 3}) == allSections);
+    // Only seen going back toward the camera
+    REQUIRE(culler.visibleSections({2, -3}) == 0);
+}
+
+TEST_CASE("OcclusionCuller only walks through the frustum") {
+    const test_world world;
+    const auto proj =
+        math::projection<float>(1, std::numbers::pi_v<float> / 2, 1, 80);
+    const auto frustum = math::extractFrustum(
+        proj * math::translation(-camera[0], -camera[1], -camera[2]));
+
+    OcclusionCuller culler;
+    const int radius = 3;
+    culler.update(camera, radius, world.lookup(), &frustum);
+    REQUIRE(culler.visibleSections({0, -2}) != 0);
+    REQUIRE(culler.visibleSections({0, 2}) == 0);
+    REQUIRE(culler.visibleSectionCount() <
+            (2 * radius + 1) * (2 * radius + 1) * chunkSectionCount / 2);
+}
@@ -0,0 +1,144 @@
+#include <engine/component/chunk.h>
+#include <engine/data_structure/palette_array.h>
+
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <memory>
+
+TEST_CASE("palette_array get/set") {
+    palette_array<int, 100> a;
+    REQUIRE(a.is_uniform());
+    REQUIRE(a.get(42) == 0);
+
+    a.set(3, 7);
+    REQUIRE_FALSE(a.is_uniform());
+    REQUIRE(a.get(3) == 7);
+    REQUIRE(a.get(2) == 0);
+    REQUIRE(a.get(4) == 0);
+
+    a.set(3, 0);
+    REQUIRE(a.get(3) == 0);
+}
+
+TEST_CASE("palette_array grows bits only when palette is full") {
+    palette_array<int, 1000> a;
+    REQUIRE(a.bits_per_index() == 0);
+
+    a.set(0, 1);
+    REQUIRE(a.bits_per_index() == 1);
+    a.set(1, 1);
+    REQUIRE(a.bits_per_index() == 1);
+
+    a.set(2, 2);
+    REQUIRE(a.bits_per_index() == 2);
+    a.set(3, 3);
+    REQUIRE(a.bits_per_index() == 2);
+
+    for (int i = 0; i < 1000; i++) a.set(static_cast<std::size_t>(i), i % 17);
+    REQUIRE(a.palette_size() == 17);
+    REQUIRE(a.bits_per_index() == 5);
+    for (int i = 0; i < 1000; i++)
+        REQUIRE(a.get(static_cast<std::size_t>(i)) == i % 17);
+}
+
+TEST_CASE("palette_array compact") {
+    palette_array<int, 64> a;
+    a.set(0, 1);
+    a.set(1, 2);
+    a.set(2, 3);
+    REQUIRE(a.bits_per_index() == 2);
+
+    a.set(0, 0);
+    a.set(1, 0);
+    a.compact();
+    REQUIRE(a.palette_size() == 2);
+    REQUIRE(a.bits_per_index() == 1);
+    REQUIRE(a.get(2) == 3);
+    REQUIRE(a.get(3) == 0);
+
+    a.set(2, 0);
+    a.compact();
+    REQUIRE(a.is_uniform());
+    REQUIRE(a.get(2) == 0);
+}
+
+TEST_CASE("palette_array fill") {
+    palette_array<int, 64> a;
+    a.set(0, 1);
+    a.set(1, 2);
+    a.fill(3);
+    REQUIRE(a.is_uniform());
+    REQUIRE(a.palette_size() == 1);
+    REQUIRE(a.get(10) == 3);
+}
+
+namespace {
+const std::size_t chunkBlockCount = chunkWidth * chunkHeight * chunkWidth;
+using chunk_storage = palette_array<BlockData, chunkBlockCount>;
+
+struct naive_block_storage {
+    BlockData blocks[chunkWidth][chunkHeight][chunkWidth];  // NOLINT
+};
+
+template <class Storage>
+void fill_terrain(Storage& s, int height) {
+    for (std::size_t y = 0; y < static_cast<std::size_t>(height); y++)
+        for (std::size_t z = 0; z < chunkWidth; z++)
+            for (std::size_t x = 0; x < chunkWidth; x++)
+                s.set(x + chunkWidth * (z + chunkWidth * y),
+                      {BlockType::Grass});
+}
+}  // namespace
+
+TEST_CASE("block_storage uses less memory than a naive array") {
+    chunk_storage storage;
+    fill_terrain(storage, 10);
+
+    REQUIRE(storage.bytes() < sizeof(naive_block_storage));
+}
+
+TEST_CASE("block_storage benchmark", "[.][benchmark]") {
+    const int height = 10;
+    chunk_storage storage;
+    fill_terrain(storage, height);
+    auto naive = std::make_unique<naive_block_storage>();
+    for (std::size_t y = 0; y < height; y++)
+        for (std::size_t z = 0; z < chunkWidth; z++)
+            for (std::size_t x = 0; x < chunkWidth; x++)
+                naive->blocks[x][y][z] = {BlockType::Grass};
+
+    WARN("625 chunks: palette " << 625 * storage.bytes() << " bytes, naive "
+                                << 625 * sizeof(naive_block_storage)
+                                << " bytes");
+
+    BENCHMARK("palette read") {
+        int count = 0;
+        for (std::size_t i = 0; i < chunkBlockCount; i++)
+            count += storage.get(i).type != BlockType::Empty;
+        return count;
+    };
+
+    BENCHMARK("naive read") {
+        int count = 0;
+        for (std::size_t y = 0; y < chunkHeight; y++)
+            for (std::size_t z = 0; z < chunkWidth; z++)
+                for (std::size_t x = 0; x < chunkWidth; x++)
+                    count += naive->blocks[x][y][z].type != BlockType::Empty;
+        return count;
+    };
+
+    BENCHMARK("palette write") {
+        chunk_storage s;
+        fill_terrain(s, height);
+        return s.bits_per_index();
+    };
+
+    BENCHMARK("naive write") {
+        auto s = std::make_unique<naive_block_storage>();
+        for (std::size_t y = 0; y < height; y++)
+            for (std::size_t z = 0; z < chunkWidth; z++)
+                for (std::size_t x = 0; x < chunkWidth; x++)
+                    s->blocks[x][y][z] = {BlockType::Grass};
+        return s;
+    };
+}
@@ -0,0 +1,66 @@
+#include <engine/data/program_binary_cache.h>
+
+#include <catch2/catch.hpp>
+#include <filesystem>
+#include <fstream>
+
+#include "temporary_directory.h"
+
+namespace {
+program_binary make_binary() {
+    program_binary binary;
+    binary.format = 0x8741;
+    binary.compile_time = std::chrono::microseconds{12345};
+    for (int i = 0; i < 1000; i++)
+        binary.data.push_back(static_cast<std::byte>(i * 7));
+    return binary;
+}
+}  // namespace
+
+TEST_CASE("ProgramBinaryCache save and load") {
+    temporary_directory dir;
+    ProgramBinaryCache cache{dir.path};
+    const auto key = ProgramBinaryCache::key("driver", "vertex", "fragment");
+
+    REQUIRE_FALSE(cache.load(key).has_value());
+
+    const auto binary = make_binary();
+    cache.save(key, binary);
+    const auto loaded = cache.load(key);
+    REQUIRE(loaded.has_value());
+    REQUIRE(loaded->format == binary.format);
+    REQUIRE(loaded->compile_time == binary.compile_time);
+    REQUIRE(loaded->data == binary.data);
+
+    // Saved again after the driver refused it
+    auto replaced = binary;
+    replaced.data.resize(10);
+    cache.save(key, replaced);
+    REQUIRE(cache.load(key)->data == replaced.data);
+}
+
+TEST_CASE("ProgramBinaryCache keys depend on the sources and the driver") {
+    const auto key = ProgramBinaryCache::key("driver", "vertex", "fragment");
+    REQUIRE(key == ProgramBinaryCache::key("driver", "vertex", "fragment"));
+    REQUIRE(key != ProgramBinaryCache::key("driver 2", "vertex", "fragment"));
+    REQUIRE(key != ProgramBinaryCache::key("driver", "vertex 2", "fragment"));
+    REQUIRE(key != ProgramBinaryCache::key("driver", "vertex", "fragment 2"));
+    REQUIRE(key != ProgramBinaryCache::key("driver", "vertexf", "ragment"));
+}
+
+TEST_CASE("ProgramBinaryCache ignores broken entries") {
+    temporary_directory dir;
+    ProgramBinaryCache cache{dir.path};
+    const auto key = ProgramBinaryCache::key("driver", "vertex", "fragment");
+    cache.save(key, make_binary());
+    const auto path = cache.entry_path(key);
+
+    SECTION("truncated") {
+        fs::resize_file(path, fs::file_size(path) - 1);
+        REQUIRE_FALSE(cache.load(key).has_value());
+    }
+    SECTION("not a program binary") {
+        std::ofstream{path, std::ios::binary} << "garbage garbage garbage";
+        REQUIRE_FALSE(cache.load(key).has_value());
+    }
+}
@@ -0,0 +1,86 @@
+#include <engine/data_structure/range_allocator.h>
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <utility>
+#include <vector>
+
+TEST_CASE("range_allocator hands out the first range that fits") {
+    range_allocator allocator{100};
+    REQUIRE(allocator.allocate(10) == 0);
+    REQUIRE(allocator.allocate(20) == 10);
+    REQUIRE(allocator.allocate(30) == 30);
+    REQUIRE(allocator.used() == 60);
+
+    allocator.release(0, 10);
+    REQUIRE(allocator.allocate(15) == 60);  // does not fit in the first one
+    REQUIRE(allocator.allocate(5) == 0);
+    REQUIRE(allocator.allocate(30) == std::nullopt);
+    REQUIRE(allocator.used() == 70);
+}
+
+TEST_CASE("range_allocator merges released ranges") {
+    range_allocator allocator{40};
+    for (std::size_t i = 0; i < 4; i++)
+        REQUIRE(allocator.allocate(10) == 10 * i);
+    REQUIRE(allocator.free_range_count() == 0);
+
+    allocator.release(0, 10);
+    allocator.release(20, 10);
+    REQUIRE(allocator.free_range_count() == 2);
+
+    // Merged with both the previous and the next free range
+    allocator.release(10, 10);
+    REQUIRE(allocator.free_range_count() == 1);
+    REQUIRE(allocator.allocate(30) == 0);
+
+    allocator.release(0, 30);
+    allocator.release(30, 10);
+    REQUIRE(allocator.free_range_count() == 1);
+    REQUIRE(allocator.used() == 0);
+    REQUIRE(allocator.allocate(40) == 0);
+}
+
+TEST_CASE("range_allocator grows at the end") {
+    range_allocator allocator{10};
+    REQUIRE(allocator.allocate(8) == 0);
+    REQUIRE(allocator.allocate(8) == std::nullopt);
+
+    // The free end of the old capacity is merged with the new units
+    allocator.grow(20);
+    REQUIRE(allocator.capacity() == 20);
+    REQUIRE(allocator.free_range_count() == 1);
+    REQUIRE(allocator.allocate(12) == 8);
+    REQUIRE(allocator.used() == 20);
+}
+
+TEST_CASE("range_allocator ends up in one piece") {
+    const std::size_t capacity = 1000;
+    range_allocator allocator{capacity};
+    std::mt19937 random{42};  // NOLINT
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+
+    for (int i = 0; i < 1000; i++) {
+        if (!ranges.empty() && random() % 2 == 0) {
+            const auto which = random() % ranges.size();
+            const auto [offset, size] = ranges[which];
+            ranges.erase(ranges.begin() + static_cast<std::ptrdiff_t>(which));
+            allocator.release(offset, size);
+            continue;
+        }
+
+        const std::size_t size = 1 + random() % 50;
+        if (auto offset = allocator.allocate(size)) {
+            for (const auto& [other_offset, other_size] : ranges)
+                REQUIRE((*offset + size <= other_offset ||
+                         other_offset + other_size <= *offset));
+            REQUIRE(*offset + size <= capacity);
+            ranges.emplace_back(*offset, size);
+        }
+    }
+
+    for (const auto& [offset, size] : ranges) allocator.release(offset, size);
+    REQUIRE(allocator.used() == 0);
+    REQUIRE(allocator.free_range_count() == 1);
+    REQUIRE(allocator.allocate(capacity) == 0);
+}
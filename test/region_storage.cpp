@@ -0,0 +1,148 @@
+#include <engine/component/chunk.h>
+#include <engine/data/region_storage.h>
+
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "temporary_directory.h"
+
+namespace {
+bool same_blocks(const Chunk& lhs, const Chunk& rhs) {
+    for (auto [x, y, z] : chunk_range_it{})
+        if (lhs.getBlock({x, y, z}) != rhs.getBlock({x, y, z})) return false;
+    return true;
+}
+
+// Grass and air with a whole byte per block, as a region file may store them:
+// two kinds of blocks packed in one bit never fill a sector
+Chunk wide_chunk(chunk_identifier id) {
+    std::array<block_storage, chunkSectionCount> sections;
+    for (auto& section : sections) {
+        std::vector<block_storage::word_type> words(chunkSectionBlockCount / 8);
+        for (std::size_t i = 0; i < words.size(); i++)
+            for (std::size_t byte = 0; byte < 8; byte++)
+                if ((i * 8 + byte) % 3 == 0)
+                    words[i] |= block_storage::word_type{1} << (8 * byte);
+        section = *block_storage::from_raw(
+            {{BlockType::Empty}, {BlockType::Grass}}, 8, std::move(words));
+    }
+    return {id, std::move(sections)};
+}
+
+// Raw access to the bytes of a file
+template <typename T>
+T read_at(const fs::path& path, std::size_t offset) {
+    std::ifstream f(path, std::ios::binary);
+    T value{};
+    f.seekg(static_cast<std::streamoff>(offset));
+    f.read(reinterpret_cast<char*>(&value), sizeof(T));  // NOLINT
+    return value;
+}
+
+template <typename T>
+void write_at(const fs::path& path, std::size_t offset, T value) {
+    std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+    f.seekp(static_cast<std::streamoff>(offset));
+    f.write(reinterpret_cast<const char*>(&value), sizeof(T));  // NOLINT
+}
+
+// Offset table entry of chunk (0, 0): first sector, then length
+const std::size_t sector_offset = 3 * sizeof(std::uint32_t);
+const std::size_t length_offset = sector_offset + sizeof(std::uint32_t);
+}  // namespace
+
+TEST_CASE("RegionStorage save and load") {
+    temporary_directory dir;
+    RegionStorage storage{dir.path};
+
+    REQUIRE_FALSE(storage.load({0, 0}).has_value());
+
+    Chunk chunk{{-33, 5}};
+    chunk.setBlock(3, 200, 4, {BlockType::Grass});
+    storage.save(chunk);
+
+    auto loaded = storage.load({-33, 5});
+    REQUIRE(loaded.has_value());
+    REQUIRE(same_blocks(chunk, *loaded));
+
+    // Same region, never saved
+    REQUIRE_FALSE(storage.load({-34, 5}).has_value());
+    // Other region
+    REQUIRE_FALSE(storage.load({0, 5}).has_value());
+}
+
+TEST_CASE("RegionStorage overwrites chunks") {
+    temporary_directory dir;
+    Chunk first{{1, 2}};
+    Chunk second{{2, 2}};
+    {
+        RegionStorage storage{dir.path};
+        storage.save(first);
+        storage.save(second);
+        // The region is mapped before the next saves
+        REQUIRE(storage.load({1, 2}).has_value());
+        const auto path = storage.region_path({1, 2});
+        const auto size = fs::file_size(path);
+
+        // Still fits in its sector, written in place
+        first.setBlock(0, 0, 0, {BlockType::Grass});
+        storage.save(first);
+        REQUIRE(fs::file_size(path) == size);
+        REQUIRE(same_blocks(first, *storage.load({1, 2})));
+
+        // Needs more than a sector, moved to the end
+        first = wide_chunk({1, 2});
+        storage.save(first);
+        REQUIRE(fs::file_size(path) > size + RegionStorage::sector_size);
+        REQUIRE(same_blocks(first, *storage.load({1, 2})));
+        REQUIRE(same_blocks(second, *storage.load({2, 2})));
+    }
+
+    RegionStorage storage{dir.path};
+    auto loaded_first = storage.load({1, 2});
+    auto loaded_second = storage.load({2, 2});
+    REQUIRE(loaded_first.has_value());
+    REQUIRE(loaded_second.has_value());
+    REQUIRE(same_blocks(first, *loaded_first));
+    REQUIRE(same_blocks(second, *loaded_second));
+}
+
+TEST_CASE("RegionStorage rejects invalid files") {
+    temporary_directory dir;
+    const auto path = RegionStorage{dir.path}.region_path({0, 0});
+    auto save_grass = [&] {
+        Chunk chunk{{0, 0}};
+        chunk.setBlock(1, 2, 3, {BlockType::Grass});
+        RegionStorage{dir.path}.save(chunk);
+        REQUIRE(RegionStorage{dir.path}.load({0, 0}).has_value());
+    };
+
+    SECTION("Not a region file") {
+        fs::create_directories(dir.path);
+        std::ofstream(path) << "definitely not a region";
+    }
+    SECTION("Unknown block type") {
+        save_grass();
+        // x, z, then the bits, the palette size and the palette of the first
+        // section: air, grass
+        const std::size_t grass =
+            read_at<std::uint32_t>(path, sector_offset) *
+                RegionStorage::sector_size +
+            2 * sizeof(std::int32_t) + 1 + sizeof(std::uint16_t) + 1;
+        REQUIRE(read_at<std::uint8_t>(path, grass) ==
+                static_cast<std::uint8_t>(BlockType::Grass));
+        write_at(path, grass, std::uint8_t{0x7f});
+    }
+    SECTION("Trailing bytes after the last section") {
+        save_grass();
+        // Takes a byte of the zero padding
+        write_at(path, length_offset,
+                 read_at<std::uint32_t>(path, length_offset) + 1);
+    }
+
+    REQUIRE_FALSE(RegionStorage{dir.path}.load({0, 0}).has_value());
+}
@@ -0,0 +1,76 @@
+#include <engine/component/mesh_arena.h>
+#include <engine/component/recording_render_device.h>
+#include <engine/system/renderer.h>
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include "temporary_directory.h"
+
+namespace {
+// Updates until every chunk of the window is uploaded
+bool load_window(Renderer& renderer) {
+    using namespace std::chrono_literals;
+    const auto deadline = std::chrono::steady_clock::now() + 60s;
+    auto& world = renderer.getWorld();
+    while (world.ready_chunk_count() < world.window_chunk_count()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        renderer.update(0.f);
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+}  // namespace
+
+TEST_CASE("Renderer submits a frame in one draw call") {
+    temporary_directory dir;
+    RecordingRenderDevice device;
+    Renderer renderer{device, dir.path / "world", dir.path / "cache"};
+    renderer.setWindowSize(800, 600);
+    REQUIRE(load_window(renderer));
+
+    device.resetStats();
+    renderer.render();
+    const auto& stats = device.stats();
+    const auto& world = renderer.getWorld();
+
+    REQUIRE(world.draw_count() > 0);
+    REQUIRE(stats.draw_calls == 1);
+    REQUIRE(stats.draws == world.draw_count());
+    // The camera block, nothing else goes through uniforms
+    REQUIRE(stats.uniform_writes == 1);
+    REQUIRE(stats.objects_created == 0);
+    REQUIRE(stats.objects_deleted == 0);
+    // Only the per frame streams: the camera, the commands and the origins
+    const std::size_t per_draw =
+        sizeof(draw_elements_command) + sizeof(mesh_origin);
+    REQUIRE(stats.bytes_uploaded ==
+            2 * sizeof(math::mat4f) + world.draw_count() * per_draw);
+}
+
+TEST_CASE("Renderer submission benchmark", "[.][benchmark]") {
+    temporary_directory dir;
+    RecordingRenderDevice device;
+    Renderer renderer{device, dir.path / "world", dir.path / "cache"};
+    renderer.setWindowSize(800, 600);
+    REQUIRE(load_window(renderer));
+
+    device.resetStats();
+    renderer.render();
+    WARN(device.stats().draws << " draws, " << device.stats().state_changes
+                              << " state changes, "
+                              << device.stats().bytes_uploaded
+                              << " bytes uploaded per frame");
+
+    BENCHMARK("render") {
+        renderer.render();
+        return device.stats().draw_calls;
+    };
+    BENCHMARK("update and render") {
+        renderer.update(0.f);
+        renderer.render();
+        return device.stats().draw_calls;
+    };
+}
@@ -0,0 +1,30 @@
+#include <engine/data_structure/ring_buffer.h>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("ring_buffer keeps the last values") {
+    ring_buffer<int> ring{3};
+    REQUIRE(ring.empty());
+    REQUIRE(ring.capacity() == 3);
+
+    ring.push_back(1);
+    ring.push_back(2);
+    REQUIRE(ring.size() == 2);
+    REQUIRE(ring[0] == 1);
+    REQUIRE(ring.back() == 2);
+
+    ring.push_back(3);
+    ring.push_back(4);
+    ring.push_back(5);
+    REQUIRE(ring.size() == 3);
+    REQUIRE(ring[0] == 3);
+    REQUIRE(ring[1] == 4);
+    REQUIRE(ring[2] == 5);
+    REQUIRE(ring.back() == 5);
+
+    ring.clear();
+    REQUIRE(ring.empty());
+    ring.push_back(6);
+    REQUIRE(ring[0] == 6);
+    REQUIRE(ring.back() == 6);
+}
@@ -0,0 +1,104 @@
+#include <engine/component/chunk.h>
+#include <engine/data_structure/scratch_arena.h>
+#include <engine/system/terrain_generator.h>
+
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+// Counts the allocations of the calling thread, for the whole test executable
+namespace {
+thread_local std::size_t allocations = 0;
+
+template <typename F>
+std::size_t count_allocations(F&& f) {
+    const std::size_t before = allocations;
+    f();
+    return allocations - before;
+}
+}  // namespace
+
+void* operator new(std::size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t /*size*/) noexcept { std::free(p); }
+
+namespace {
+struct test_buffers {
+    std::vector<int> values;
+};
+}  // namespace
+
+TEST_CASE("scratch_arena keeps the buffers of each thread") {
+    const int* data = nullptr;
+    {
+        scratch_arena<test_buffers> scratch;
+        scratch->values.assign(100, 1);
+        data = scratch->values.data();
+    }
+
+    // Reused by the same thread
+    const int* reused = nullptr;
+    REQUIRE(count_allocations([&] {
+                scratch_arena<test_buffers> scratch;
+                scratch->values.assign(50, 2);
+                reused = scratch->values.data();
+            }) == 0);
+    REQUIRE(reused == data);
+
+    // Not shared with the other threads
+    std::thread other{[&] {
+        scratch_arena<test_buffers> scratch;
+        REQUIRE(scratch->values.empty());
+    }};
+    other.join();
+}
+
+TEST_CASE("Meshing a chunk only allocates its mesh") {
+    const auto chunk =
+        std::make_shared<const Chunk>(TerrainGenerator{7}.generate({1, -4}));
+
+    for (auto mode : {MeshingMode::PerFace, MeshingMode::Greedy}) {
+        // Grows the scratch buffers of this thread
+        const ChunkSimplifyerProxy warm_up{chunk, mode};
+
+        std::size_t mesh_size = 0;
+        const auto first = count_allocations([&] {
+            const ChunkSimplifyerProxy proxy{chunk, mode};
+            mesh_size = proxy.mesh.size();
+        });
+        REQUIRE(mesh_size > 0);
+        REQUIRE(first == 1);
+
+        // Same size, the mesh is rebuilt in place
+        ChunkSimplifyerProxy proxy{chunk, mode};
+        REQUIRE(count_allocations([&] { proxy.simplify(); }) == 0);
+    }
+}
+
+TEST_CASE("Generating a chunk only allocates its sections") {
+    const TerrainGenerator generator{7};
+    const chunk_identifier id{3, 8};
+    const auto warm_up = generator.generate(id);
+
+    // At most a palette per section, plus for the mixed ones a new palette and
+    // new indices per bit of index. The generator itself allocates nothing
+    std::size_t mixed_sections = 0;
+    std::size_t max_allocations = 0;
+    for (std::size_t section = 0; section < chunkSectionCount; section++) {
+        const auto& storage = warm_up.getSection(section);
+        if (!storage.is_uniform()) mixed_sections++;
+        max_allocations += 1 + 2 * storage.bits_per_index();
+    }
+    REQUIRE(mixed_sections > 0);
+
+    REQUIRE(count_allocations([&] { (void)generator.generate(id); }) <=
+            max_allocations);
+}
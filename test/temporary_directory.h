@@ -0,0 +1,39 @@
+#ifndef TEMPORARY_DIRECTORY_H_
+#define TEMPORARY_DIRECTORY_H_
+
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <cctype>
+#include <filesystem>
+#include <string>
+
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// A directory removed with its content at the end of the scope. Named after the
+// test case and the process, so tests running in parallel (ctest -j) never
+// share one
+struct temporary_directory {
+    fs::path path = fs::temp_directory_path() / unique_name();
+
+    temporary_directory() { fs::remove_all(path); }
+    ~temporary_directory() { fs::remove_all(path); }
+
+   private:
+    static std::string unique_name() {
+        static std::atomic<int> count = 0;
+        std::string name =
+            "mineclone_" + Catch::getResultCapture().getCurrentTestName();
+        for (auto& c : name)
+            if (!std::isalnum(static_cast<unsigned char>(c))) c = '_';
+#ifdef __unix__
+        name += "_" + std::to_string(::getpid());
+#endif
+        return name + "_" + std::to_string(count++);
+    }
+};
+
+#endif  // !TEMPORARY_DIRECTORY_H_
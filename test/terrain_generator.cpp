@@ -0,0 +1,68 @@
+#include <engine/component/chunk.h>
+#include <engine/system/terrain_generator.h>
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cstddef>
+
+TEST_CASE("TerrainGenerator SIMD heights match the scalar ones") {
+    TerrainGenerator generator{1234};
+    for (int x = -3; x <= 3; x++)
+        for (int z = -3; z <= 3; z++)
+            REQUIRE(generator.heights({x, z}) ==
+                    generator.heights_scalar({x, z}));
+
+    // Far from the origin
+    REQUIRE(generator.heights({100000, -100000}) ==
+            generator.heights_scalar({100000, -100000}));
+}
+
+TEST_CASE("TerrainGenerator is deterministic") {
+    TerrainGenerator generator{42};
+    TerrainGenerator same{42};
+    TerrainGenerator other{43};
+
+    REQUIRE(generator.heights({5, -7}) == same.heights({5, -7}));
+    REQUIRE(generator.heights({5, -7}) != other.heights({5, -7}));
+}
+
+TEST_CASE("TerrainGenerator fills columns up to their height") {
+    TerrainGenerator generator{42};
+    const chunk_identifier id{-2, 9};
+    const auto heights = generator.heights(id);
+    const auto chunk = generator.generate(id);
+
+    for (std::size_t z = 0; z < chunkWidth; z++) {
+        for (std::size_t x = 0; x < chunkWidth; x++) {
+            const auto height =
+                static_cast<std::size_t>(heights[x + chunkWidth * z]);
+            REQUIRE(chunk.getHeight(x, z) == static_cast<int>(height));
+            REQUIRE(chunk.getBlock({x, height, z}).type == BlockType::Grass);
+            REQUIRE(chunk.getBlock({x, 0, z}).type == BlockType::Grass);
+            if (height + 1 < chunkHeight)
+                REQUIRE(chunk.getBlock({x, height + 1, z}).type ==
+                        BlockType::Empty);
+        }
+    }
+
+    REQUIRE(chunk.isSectionEmpty(chunkSectionCount - 1));
+}
+
+TEST_CASE("TerrainGenerator benchmark", "[.][benchmark]") {
+    TerrainGenerator generator{42};
+
+    const int chunk_count = 256;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < chunk_count; i++) {
+        auto chunk = generator.generate({i % 16, i / 16});
+        REQUIRE(chunk.getId().x == i % 16);
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    WARN(TerrainGenerator::simd_name()
+         << ": " << chunk_count / elapsed.count() << " chunks/s on one core");
+
+    BENCHMARK("heights") { return generator.heights({3, 4}); };
+    BENCHMARK("heights scalar") { return generator.heights_scalar({3, 4}); };
+    BENCHMARK("generate") { return generator.generate({3, 4}); };
+}
@@ -0,0 +1,52 @@
+#include <engine/data_structure/bounded_queue.h>
+#include <engine/utils/thread_pool.h>
+
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <set>
+#include <thread>
+
+TEST_CASE("ThreadPool tasks results go through a bounded_queue") {
+    const int task_count = 100;
+    bounded_queue<int> results{4};  // smaller than task_count: workers block
+    std::set<int> received;
+    std::size_t max_size = 0;
+    {
+        ThreadPool pool{3};
+        for (int i = 0; i < task_count; i++)
+            pool.submit([&results, i] { results.push(i); });
+
+        while (received.size() < task_count) {
+            if (auto value = results.try_pop()) received.insert(*value);
+            max_size = std::max(max_size, results.size());
+        }
+    }
+    REQUIRE(max_size <= 4);
+    REQUIRE(received.size() == task_count);
+    REQUIRE(*received.begin() == 0);
+    REQUIRE(*received.rbegin() == task_count - 1);
+}
+
+TEST_CASE("bounded_queue close rejects producers") {
+    bounded_queue<int> queue{1};
+    REQUIRE(queue.push(1));
+
+    std::atomic<bool> started = false;
+    bool pushed = true;
+    {
+        ThreadPool pool{1};
+        pool.submit([&] {
+            started = true;
+            pushed = queue.push(2);  // blocks, queue is full
+        });
+        while (!started) std::this_thread::yield();
+
+        queue.close();
+    }  // joins the worker
+
+    REQUIRE_FALSE(pushed);
+    REQUIRE(queue.try_pop() == 1);
+    REQUIRE_FALSE(queue.try_pop().has_value());
+}